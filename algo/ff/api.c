@@ -0,0 +1,196 @@
+// api.c
+// mms simulator backend for api.h: commands go to stdout, replies come from stdin
+
+#include "api.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BUFFER_SIZE 32
+#define COMMAND_BUFFER_SIZE 16384
+
+// fire-and-forget commands (setWall, setColor, setText, clear*) are batched
+// here and written to mms in one go right before the next command that
+// needs a reply, instead of one printf + fflush per call
+static char commandBuffer[COMMAND_BUFFER_SIZE];
+static size_t commandLength = 0;
+
+void API_flush() {
+  if (commandLength > 0) {
+    fwrite(commandBuffer, 1, commandLength, stdout);
+    commandLength = 0;
+  }
+  fflush(stdout);
+}
+
+static void queueCommand(const char *format, ...) {
+  static int flushAtExit = 0;
+  if (!flushAtExit) {
+    // drawing commands issued right before the program ends still reach mms
+    atexit(API_flush);
+    flushAtExit = 1;
+  }
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    size_t space = COMMAND_BUFFER_SIZE - commandLength;
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(commandBuffer + commandLength, space, format, args);
+    va_end(args);
+    if (written >= 0 && (size_t)written < space) {
+      commandLength += written;
+      return;
+    }
+    // buffer full: send what we have and retry with an empty buffer
+    API_flush();
+  }
+}
+
+// sends any batched commands together with the query, then waits for the reply
+static void sendQuery(char *command) {
+  queueCommand("%s\n", command);
+  API_flush();
+}
+
+static int getInteger(char *command) {
+  sendQuery(command);
+  char response[BUFFER_SIZE];
+  fgets(response, BUFFER_SIZE, stdin);
+  int value = atoi(response);
+  return value;
+}
+
+static int getBoolean(char *command) {
+  sendQuery(command);
+  char response[BUFFER_SIZE];
+  fgets(response, BUFFER_SIZE, stdin);
+  int value = (strcmp(response, "true\n") == 0);
+  return value;
+}
+
+static int getAck(char *command) {
+  sendQuery(command);
+  char response[BUFFER_SIZE];
+  fgets(response, BUFFER_SIZE, stdin);
+  int success = (strcmp(response, "ack\n") == 0);
+  return success;
+}
+
+int API_mazeWidth() { return getInteger("mazeWidth"); }
+
+int API_mazeHeight() { return getInteger("mazeHeight"); }
+
+int API_wallFront() { return getBoolean("wallFront"); }
+
+int API_wallRight() { return getBoolean("wallRight"); }
+
+int API_wallLeft() { return getBoolean("wallLeft"); }
+
+// the three queries go out in one write and the replies are read back in order,
+// so the program waits on mms once per cell instead of three times
+int API_readWalls() {
+  queueCommand("wallFront\nwallRight\nwallLeft\n");
+  API_flush();
+  int walls = 0;
+  for (int bit = 1; bit <= 4; bit <<= 1) {
+    char response[BUFFER_SIZE];
+    fgets(response, BUFFER_SIZE, stdin);
+    if (strcmp(response, "true\n") == 0) {
+      walls |= bit;
+    }
+  }
+  return walls;
+}
+
+int API_moveForward() { return getAck("moveForward"); }
+
+int API_moveForwardN(int distance) {
+  char command[BUFFER_SIZE];
+  sprintf(command, "moveForward %d", distance);
+  return getAck(command);
+}
+
+void API_turnRight() { getAck("turnRight"); }
+
+void API_turnLeft() { getAck("turnLeft"); }
+
+// mms only moves between cell centres
+int API_hasDiagonals() { return 0; }
+
+int API_moveHalf() { return 0; }
+
+int API_moveDiagonal(int segments) {
+  (void)segments;
+  return 0;
+}
+
+void API_turnRight45() {}
+
+void API_turnLeft45() {}
+
+// every mms command blocks until the move is done
+int API_hasMoveStart() { return 0; }
+
+void API_moveForwardStart() {}
+
+int API_moveForwardFinish() { return API_moveForward(); }
+
+// mms only answers sensor queries at the cell centre
+int API_hasWallsAhead() { return 0; }
+
+int API_wallsAhead(int *walls) {
+  (void)walls;
+  return 0;
+}
+
+// mms has no goal command, its goal is always the centre
+int API_hasGoalCells() { return 0; }
+
+int API_isGoal(int x, int y) {
+  (void)x;
+  (void)y;
+  return 0;
+}
+
+void API_setWall(int x, int y, char direction) {
+  queueCommand("setWall %d %d %c\n", x, y, direction);
+}
+
+void API_clearWall(int x, int y, char direction) {
+  queueCommand("clearWall %d %d %c\n", x, y, direction);
+}
+
+void API_setColor(int x, int y, char color) {
+  queueCommand("setColor %d %d %c\n", x, y, color);
+}
+
+void API_clearColor(int x, int y) {
+  queueCommand("clearColor %d %d\n", x, y);
+}
+
+void API_clearAllColor() {
+  queueCommand("clearAllColor\n");
+}
+
+void API_setText(int x, int y, char *text) {
+  queueCommand("setText %d %d %s\n", x, y, text);
+}
+
+void API_clearText(int x, int y) {
+  queueCommand("clearText %d %d\n", x, y);
+}
+
+void API_clearAllText() {
+  queueCommand("clearAllText\n");
+}
+
+// bracket the algorithm's flood fill so the headless backend can report the
+// cpu time spent in it; mms has no use for them
+void API_floodFillBegin() {}
+
+void API_floodFillEnd() {}
+
+int API_wasReset() { return getBoolean("wasReset"); }
+
+void API_ackReset() { getAck("ackReset"); }
@@ -1,93 +1,62 @@
 #pragma once
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
 
-#define BUFFER_SIZE 32
-
-int getInteger(char *command) {
-  printf("%s\n", command);
-  fflush(stdout);
-  char response[BUFFER_SIZE];
-  fgets(response, BUFFER_SIZE, stdin);
-  int value = atoi(response);
-  return value;
-}
-
-int getBoolean(char *command) {
-  printf("%s\n", command);
-  fflush(stdout);
-  char response[BUFFER_SIZE];
-  fgets(response, BUFFER_SIZE, stdin);
-  int value = (strcmp(response, "true\n") == 0);
-  return value;
-}
-
-int getAck(char *command) {
-  printf("%s\n", command);
-  fflush(stdout);
-  char response[BUFFER_SIZE];
-  fgets(response, BUFFER_SIZE, stdin);
-  int success = (strcmp(response, "ack\n") == 0);
-  return success;
-}
-
-int API_mazeWidth() { return getInteger("mazeWidth"); }
-
-int API_mazeHeight() { return getInteger("mazeHeight"); }
-
-int API_wallFront() { return getBoolean("wallFront"); }
-
-int API_wallRight() { return getBoolean("wallRight"); }
-
-int API_wallLeft() { return getBoolean("wallLeft"); }
-
-int API_moveForward() { return getAck("moveForward"); }
-
-void API_turnRight() { getAck("turnRight"); }
-
-void API_turnLeft() { getAck("turnLeft"); }
-
-void API_setWall(int x, int y, char direction) {
-  printf("setWall %d %d %c\n", x, y, direction);
-  fflush(stdout);
-}
-
-void API_clearWall(int x, int y, char direction) {
-  printf("clearWall %d %d %c\n", x, y, direction);
-  fflush(stdout);
-}
-
-void API_setColor(int x, int y, char color) {
-  printf("setColor %d %d %c\n", x, y, color);
-  fflush(stdout);
-}
-
-void API_clearColor(int x, int y) {
-  printf("clearColor %d %d\n", x, y);
-  fflush(stdout);
-}
-
-void API_clearAllColor() {
-  printf("clearAllColor\n");
-  fflush(stdout);
-}
-
-void API_setText(int x, int y, char *text) {
-  printf("setText %d %d %s\n", x, y, text);
-  fflush(stdout);
-}
-
-void API_clearText(int x, int y) {
-  printf("clearText %d %d\n", x, y);
-  fflush(stdout);
-}
-
-void API_clearAllText() {
-  printf("clearAllText\n");
-  fflush(stdout);
-}
-
-int API_wasReset() { return getBoolean("wasReset"); }
-
-void API_ackReset() { getAck("ackReset"); }
+// api.h
+// mms simulator api. two backends implement it, pick one at link time:
+//   api.c     - the mms stdin/stdout protocol
+//   api_sim.c - headless, answered in-process from a maze file (see sim.h)
+
+int API_mazeWidth();
+int API_mazeHeight();
+
+int API_wallFront();
+int API_wallRight();
+int API_wallLeft();
+int API_readWalls(); // all three in one round trip: front 1, right 2, left 4
+
+int API_moveForward();
+int API_moveForwardN(int distance); // distance cells in one motion, 0 on crash
+void API_turnRight();
+void API_turnLeft();
+
+// 45 degree motion for diagonal speed runs, only where API_hasDiagonals() is
+// set. mms has none of it, so solvers there fall back to orthogonal moves
+int API_hasDiagonals();
+int API_moveHalf();                 // half a cell along the heading, 0 on crash
+int API_moveDiagonal(int segments); // segments half-diagonals, 0 on crash
+void API_turnRight45();
+void API_turnLeft45();
+
+// one-cell move split so the caller can compute while the mouse drives, only
+// where API_hasMoveStart() is set
+int API_hasMoveStart();
+void API_moveForwardStart();
+int API_moveForwardFinish(); // 0 on crash, like API_moveForward
+// walls of the cell being entered, sensed during the move, only where
+// API_hasWallsAhead() is set. 0 while they are not in yet
+int API_hasWallsAhead();
+int API_wallsAhead(int *walls); // API_readWalls bits
+
+// goal cells other than the mms centre 2x2, only where API_hasGoalCells() is
+// set. mms always uses the centre
+int API_hasGoalCells();
+int API_isGoal(int x, int y);
+
+void API_setWall(int x, int y, char direction);
+void API_clearWall(int x, int y, char direction);
+void API_setColor(int x, int y, char color);
+void API_clearColor(int x, int y);
+void API_clearAllColor();
+void API_setText(int x, int y, char *text);
+void API_clearText(int x, int y);
+void API_clearAllText();
+
+// sends any batched drawing commands now
+void API_flush();
+
+// bracket the algorithm's flood fill so the headless backend can report the
+// cpu time spent in it; mms has no use for them
+void API_floodFillBegin();
+void API_floodFillEnd();
+
+int API_wasReset();
+void API_ackReset();
@@ -0,0 +1,237 @@
+// api_sim.c
+// headless backend for the API_* functions in api.h.
+// link it instead of api.c to run any variant without the mms GUI:
+//
+//   gcc ffv1.c display.c api_sim.c sim.c corpus.c -o ffv1_headless.out
+//   SIM_MAZE_FILE=mazes/apec2019.num ./ffv1_headless.out
+//   SIM_MAZE_FILE=mazes.ffmz SIM_MAZE_ID=12 ./ffv1_headless.out
+//
+// the maze (mms .num or .map format, or maze SIM_MAZE_ID of a corpus packed
+// by tools/ffpack.c, see corpus.h) is loaded on the first API call.
+// SIM_MAX_STEPS (default 100000) aborts runs that never finish, SIM_DIAGONALS=1
+// lets the solver drive diagonal speed runs (mms cannot), SIM_PIPELINE=1 lets
+// it plan search steps during moves and sense each cell on entry,
+// SIM_GOAL_CELLS replaces the centre goal with other cells ("x,y" cells and
+// "x1,y1-x2,y2" rectangles, ';' separated, never the start cell), a one line
+// summary is printed to stderr at exit and, when SIM_STATS_FILE is set, the
+// per-phase metrics are written there (see tools/ffbench.c).
+
+#define _POSIX_C_SOURCE 200809L
+#include "api.h"
+#include "corpus.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static Sim apiSim;
+static int apiSimLoaded = 0;
+
+static double processCpuMs() {
+  struct timespec now;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+  return (double)now.tv_sec * 1e3 + (double)now.tv_nsec * 1e-6;
+}
+
+static void apiSimReport() {
+  fprintf(stderr, "sim: moves=%ld turns=%ld crashes=%ld final=(%d,%d)\n",
+          apiSim.moves, apiSim.turns, apiSim.crashes, apiSim.x, apiSim.y);
+
+  const char *path = getenv("SIM_STATS_FILE");
+  if (path != NULL && !sim_write_stats(&apiSim, path, processCpuMs())) {
+    fprintf(stderr, "sim: cannot write stats file %s\n", path);
+  }
+}
+
+// the corpus stays mapped only while its record is unpacked
+static void apiSimLoadCorpus(const char *path) {
+  const char *id = getenv("SIM_MAZE_ID");
+  Corpus corpus;
+  if (!corpus_open(&corpus, path)) {
+    exit(2);
+  }
+  const CorpusMaze *maze = id != NULL ? corpus_maze(&corpus, atol(id)) : NULL;
+  if (maze == NULL) {
+    fprintf(stderr, "sim: SIM_MAZE_ID \"%s\" is not a valid maze of the %lu in %s\n", id ? id : "",
+            (unsigned long)corpus.count, path);
+    exit(2);
+  }
+  corpus_sim(maze, &apiSim); // corpus_maze checked the record
+  corpus_close(&corpus);
+}
+
+static Sim *apiSimInstance() {
+  if (apiSimLoaded) {
+    return &apiSim;
+  }
+  apiSimLoaded = 1;
+
+  const char *path = getenv("SIM_MAZE_FILE");
+  if (path == NULL) {
+    fprintf(stderr, "sim: SIM_MAZE_FILE is not set\n");
+    exit(2);
+  }
+  if (corpus_is_file(path)) {
+    apiSimLoadCorpus(path);
+  } else if (!sim_load_file(&apiSim, path)) {
+    fprintf(stderr, "sim: cannot load maze file %s\n", path);
+    exit(2);
+  }
+  const char *goalCells = getenv("SIM_GOAL_CELLS");
+  if (goalCells != NULL && *goalCells && !sim_set_goal(&apiSim, goalCells)) {
+    fprintf(stderr, "sim: bad SIM_GOAL_CELLS \"%s\" for a %dx%d maze\n", goalCells, apiSim.width, apiSim.height);
+    exit(2);
+  }
+  const char *maxSteps = getenv("SIM_MAX_STEPS");
+  if (maxSteps != NULL) {
+    apiSim.max_steps = atol(maxSteps);
+  }
+  atexit(apiSimReport);
+  return &apiSim;
+}
+
+// runaway solvers are stopped here rather than looping forever
+static void apiSimCheckSteps() {
+  if (apiSim.step_limit_hit) {
+    fprintf(stderr, "sim: step limit of %ld exceeded\n", apiSim.max_steps);
+    exit(3);
+  }
+}
+
+int API_mazeWidth() { return apiSimInstance()->width; }
+
+int API_mazeHeight() { return apiSimInstance()->height; }
+
+int API_wallFront() { return sim_wall(apiSimInstance(), 0); }
+
+int API_wallRight() { return sim_wall(apiSimInstance(), 1); }
+
+int API_wallLeft() { return sim_wall(apiSimInstance(), 3); }
+
+int API_readWalls() { return sim_read_walls(apiSimInstance()); }
+
+int API_moveForward() {
+  int moved = sim_move_forward(apiSimInstance());
+  apiSimCheckSteps();
+  return moved;
+}
+
+int API_moveForwardN(int distance) {
+  int moved = sim_move_forward_n(apiSimInstance(), distance) == distance;
+  apiSimCheckSteps();
+  return moved;
+}
+
+void API_turnRight() {
+  sim_turn(apiSimInstance(), 1);
+  apiSimCheckSteps();
+}
+
+void API_turnLeft() {
+  sim_turn(apiSimInstance(), -1);
+  apiSimCheckSteps();
+}
+
+// off by default so headless runs match mms, SIM_DIAGONALS=1 enables them
+int API_hasDiagonals() {
+  const char *diagonals = getenv("SIM_DIAGONALS");
+  return diagonals != NULL && atoi(diagonals) != 0;
+}
+
+int API_moveHalf() {
+  int moved = sim_move_half(apiSimInstance());
+  apiSimCheckSteps();
+  return moved;
+}
+
+int API_moveDiagonal(int segments) {
+  int moved = sim_move_diagonal(apiSimInstance(), segments);
+  apiSimCheckSteps();
+  return moved;
+}
+
+void API_turnRight45() {
+  sim_turn_45(apiSimInstance(), 1);
+  apiSimCheckSteps();
+}
+
+void API_turnLeft45() {
+  sim_turn_45(apiSimInstance(), -1);
+  apiSimCheckSteps();
+}
+
+// SIM_PIPELINE=1 lets the solver plan during moves, the move itself happens
+// in API_moveForwardFinish
+int API_hasMoveStart() {
+  const char *pipeline = getenv("SIM_PIPELINE");
+  return pipeline != NULL && atoi(pipeline) != 0;
+}
+
+void API_moveForwardStart() {}
+
+int API_moveForwardFinish() { return API_moveForward(); }
+
+// with SIM_PIPELINE the next cell's walls are there as soon as the move starts
+int API_hasWallsAhead() { return API_hasMoveStart(); }
+
+int API_wallsAhead(int *walls) {
+  uint8_t bits = 0;
+  if (!sim_walls_ahead(apiSimInstance(), &bits)) {
+    return 0;
+  }
+  *walls = bits;
+  return 1;
+}
+
+int API_hasGoalCells() { return apiSimInstance()->has_goal; }
+
+int API_isGoal(int x, int y) { return sim_is_goal(apiSimInstance(), x, y); }
+
+// nothing is rendered headless
+void API_setWall(int x, int y, char direction) {
+  (void)x;
+  (void)y;
+  (void)direction;
+}
+
+void API_clearWall(int x, int y, char direction) {
+  (void)x;
+  (void)y;
+  (void)direction;
+}
+
+void API_setColor(int x, int y, char color) {
+  (void)x;
+  (void)y;
+  (void)color;
+}
+
+void API_clearColor(int x, int y) {
+  (void)x;
+  (void)y;
+}
+
+void API_clearAllColor() {}
+
+void API_setText(int x, int y, char *text) {
+  (void)x;
+  (void)y;
+  (void)text;
+}
+
+void API_clearText(int x, int y) {
+  (void)x;
+  (void)y;
+}
+
+void API_clearAllText() {}
+
+void API_flush() {}
+
+void API_floodFillBegin() { sim_flood_fill_begin(apiSimInstance()); }
+
+void API_floodFillEnd() { sim_flood_fill_end(apiSimInstance()); }
+
+int API_wasReset() { return 0; }
+
+void API_ackReset() {}
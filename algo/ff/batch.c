@@ -0,0 +1,200 @@
+#include "batch.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct Batch Batch;
+
+// Jobs are handed out as index ranges, one per worker, packed into one word
+// (begin in the high half, end in the low half) so the owner taking the next
+// job and a thief splitting off the back half are each a single CAS.
+typedef struct {
+    _Atomic uint64_t range; // Unclaimed jobs [begin, end)
+    Batch *batch;
+    int index;
+    BatchTotals *totals; // Per parameter set, merged once the workers are done
+    pthread_t thread;
+} Worker;
+
+struct Batch {
+    const BatchConfig *cfg;
+    BatchRun *runs;
+    Worker *workers;
+    int worker_count;
+};
+
+#define RANGE(begin, end) (((uint64_t)(begin) << 32) | (uint32_t)(end))
+#define RANGE_BEGIN(r) ((int)((r) >> 32))
+#define RANGE_END(r) ((int)((r) & 0xFFFFFFFFu))
+
+// --- Job Ranges ---
+
+// Owner side: claims the front job of w's range, -1 when it is empty
+static int take_job(Worker *w) {
+    uint64_t r = atomic_load(&w->range);
+    while (RANGE_BEGIN(r) < RANGE_END(r)) {
+        if (atomic_compare_exchange_weak(&w->range, &r, RANGE(RANGE_BEGIN(r) + 1, RANGE_END(r)))) {
+            return RANGE_BEGIN(r);
+        }
+    }
+    return -1;
+}
+
+// Thief side: moves the back half of the fullest other range into w's (empty) one
+// and claims its first job. -1 once every range is empty: jobs only ever move
+// between ranges, so none can appear later.
+static int steal_job(Worker *w) {
+    Batch *b = w->batch;
+    for (;;) {
+        Worker *victim = NULL;
+        uint64_t r = 0;
+        int most = 0;
+        for (int i = 1; i < b->worker_count; i++) {
+            Worker *v = &b->workers[(w->index + i) % b->worker_count];
+            uint64_t vr = atomic_load(&v->range);
+            if (RANGE_END(vr) - RANGE_BEGIN(vr) > most) {
+                most = RANGE_END(vr) - RANGE_BEGIN(vr);
+                victim = v;
+                r = vr;
+            }
+        }
+        if (victim == NULL) return -1;
+
+        int begin = RANGE_BEGIN(r), end = RANGE_END(r);
+        int mid = begin + (end - begin) / 2;
+        if (atomic_compare_exchange_strong(&victim->range, &r, RANGE(begin, mid))) {
+            atomic_store(&w->range, RANGE(mid + 1, end));
+            return mid;
+        }
+        // Lost the race to its owner or another thief, look again
+    }
+}
+
+// --- Runs ---
+
+static void add_run(BatchTotals *t, const BatchRun *run) {
+    t->runs++;
+    t->cpu_ms += run->cpu_ms;
+    if (!run->fits || !run->finished || !run->stats.reached_goal) t->failed++;
+    if (!run->fits) return;
+    if (run->stats.reached_goal) t->reached_goal++;
+    t->search_cells += run->stats.search_cells;
+    t->search_turns += run->stats.search_turns;
+    t->explore_cells += run->stats.explore_cells;
+    t->speed_cells += run->stats.speed_cells;
+    t->speed_turns += run->stats.speed_turns;
+    t->moves += run->stats.moves;
+    t->turns += run->stats.turns;
+    t->crashes += run->stats.crashes;
+    t->cells_touched += run->cells_touched;
+}
+
+static void run_job(Worker *w, Solver *solver, int job) {
+    const BatchConfig *cfg = w->batch->cfg;
+    int param = job / cfg->maze_count;
+    BatchRun run = {0};
+
+    double start = sim_cpu_seconds();
+    Sim sim;
+    bool loaded = true;
+    if (cfg->corpus) {
+        loaded = corpus_sim(&cfg->corpus->mazes[job % cfg->maze_count], &sim);
+    } else {
+        sim = cfg->mazes[job % cfg->maze_count];
+    }
+    if (cfg->max_steps > 0) sim.max_steps = cfg->max_steps;
+    sim.diagonals = cfg->diagonals;
+    sim.pipeline = cfg->pipeline;
+    MouseIO io = sim_io(&sim);
+    run.fits = loaded && solver_init(solver, &io);
+    if (run.fits) {
+        solver_set_params(solver, &cfg->params[param]);
+        // A mouse that ran out of steps fails every move, so stop it here
+        while (!sim.step_limit_hit && solver_step(solver)) {
+        }
+        run.finished = !sim.step_limit_hit;
+        run.stats = sim_stats(&sim);
+        run.cells_touched = solver->maze.total_cells_touched;
+    }
+
+    run.cpu_ms = (sim_cpu_seconds() - start) * 1000.0;
+    add_run(&w->totals[param], &run);
+    if (w->batch->runs) w->batch->runs[job] = run;
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = arg;
+    Solver *solver = malloc(sizeof(Solver)); // Too large for a thread's stack
+    if (solver == NULL) return NULL;
+    for (;;) {
+        int job = take_job(w);
+        if (job < 0) job = steal_job(w);
+        if (job < 0) break;
+        run_job(w, solver, job);
+    }
+    free(solver);
+    return NULL;
+}
+
+// --- Batch ---
+
+bool batch_run(const BatchConfig *cfg, BatchTotals *totals, BatchRun *runs) {
+    memset(totals, 0, cfg->param_count * sizeof(BatchTotals));
+    int jobs = cfg->maze_count * cfg->param_count;
+    if (jobs == 0) return true;
+
+    int threads = cfg->threads > 0 ? cfg->threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1) threads = 1;
+    if (threads > jobs) threads = jobs;
+
+    Batch b = {cfg, runs, calloc(threads, sizeof(Worker)), threads};
+    if (b.workers == NULL) return false;
+
+    // Equal contiguous shares to start with, stealing evens out the rest
+    for (int i = 0; i < threads; i++) {
+        Worker *w = &b.workers[i];
+        w->batch = &b;
+        w->index = i;
+        w->totals = calloc(cfg->param_count, sizeof(BatchTotals));
+        atomic_init(&w->range, RANGE((long)jobs * i / threads, (long)jobs * (i + 1) / threads));
+    }
+
+    int started = 0;
+    for (int i = 0; i < threads; i++) {
+        if (b.workers[i].totals && pthread_create(&b.workers[i].thread, NULL, worker_main, &b.workers[i]) == 0) {
+            started++;
+        } else {
+            free(b.workers[i].totals);
+            b.workers[i].totals = NULL; // Its jobs get stolen by the others
+        }
+    }
+
+    for (int i = 0; i < threads; i++) {
+        Worker *w = &b.workers[i];
+        if (w->totals == NULL) continue;
+        pthread_join(w->thread, NULL);
+        for (int p = 0; p < cfg->param_count; p++) {
+            BatchTotals *t = &totals[p];
+            const BatchTotals *s = &w->totals[p];
+            t->runs += s->runs;
+            t->reached_goal += s->reached_goal;
+            t->failed += s->failed;
+            t->search_cells += s->search_cells;
+            t->search_turns += s->search_turns;
+            t->explore_cells += s->explore_cells;
+            t->speed_cells += s->speed_cells;
+            t->speed_turns += s->speed_turns;
+            t->moves += s->moves;
+            t->turns += s->turns;
+            t->crashes += s->crashes;
+            t->cells_touched += s->cells_touched;
+            t->cpu_ms += s->cpu_ms;
+        }
+        free(w->totals);
+    }
+    free(b.workers);
+    return started > 0;
+}
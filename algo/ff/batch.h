@@ -0,0 +1,54 @@
+#pragma once
+#include "corpus.h"
+#include "sim.h"
+#include "solver.h"
+#include <stdbool.h>
+
+// batch.h
+// Runs many independent headless solves, every maze under every parameter
+// set, on a work-stealing pool of threads. Each worker has its own Solver and
+// copies the maze's Sim for every run, so the inputs are only read and nothing
+// else is shared. Builds with -DSOLVER_PROFILE share one profile table between
+// threads; sweep with an unprofiled solver.
+
+typedef struct {
+    const Sim *mazes; // Loaded with sim_load_file, left untouched
+    // Instead of mazes: maze i is record i, unpacked by the worker that runs
+    // it, so the mazes are never all loaded at once
+    const Corpus *corpus;
+    int maze_count;
+    const SolverParams *params;
+    int param_count;
+    int threads;    // Worker threads, <= 0 for one per online core
+    long max_steps; // Per run, <= 0 keeps SIM_DEFAULT_MAX_STEPS
+    // Sim.diagonals / Sim.pipeline of every run, like SIM_DIAGONALS /
+    // SIM_PIPELINE for ffbench; both off gives the same mouse as ffbench's default
+    bool diagonals;
+    bool pipeline;
+} BatchConfig;
+
+// One run. Job index = param index * maze_count + maze index
+typedef struct {
+    bool fits;     // The maze fits this build's MAZE_MAX_SIZE (false for a damaged corpus record)
+    bool finished; // The solver ended its speed run within max_steps
+    SimStats stats;
+    long cells_touched; // Flood fill work of the whole run
+    double cpu_ms;      // Thread CPU time of the run
+} BatchRun;
+
+// Sums over all mazes of one parameter set
+typedef struct {
+    int runs;
+    int reached_goal;
+    int failed; // Did not fit, ran out of steps or never reached the goal
+    long search_cells, search_turns;
+    long explore_cells;
+    long speed_cells, speed_turns;
+    long moves, turns, crashes;
+    long cells_touched;
+    double cpu_ms; // Thread CPU time of the runs
+} BatchTotals;
+
+// Solves every (maze, params) pair. totals receives param_count entries and runs,
+// unless NULL, maze_count * param_count. Returns false if no worker could start.
+bool batch_run(const BatchConfig *cfg, BatchTotals *totals, BatchRun *runs);
@@ -0,0 +1,132 @@
+#define _POSIX_C_SOURCE 200809L
+#include "corpus.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// --- Writing ---
+
+void corpus_pack(const Sim *sim, const char *name, CorpusMaze *out) {
+    memset(out, 0, sizeof(*out));
+    int w = sim->width, h = sim->height;
+    out->width = (uint8_t)w;
+    out->height = (uint8_t)h;
+    snprintf(out->name, sizeof(out->name), "%s", name);
+
+    // A segment is a wall if either cell that shares it says so
+    for (int x = 0; x < w; x++) {
+        for (int y = 0; y < h; y++) {
+            unsigned char cell = sim->walls[x][y];
+            if (cell & SIM_SOUTH) out->h_walls[y] |= 1u << x;
+            if (cell & SIM_NORTH) out->h_walls[y + 1] |= 1u << x;
+            if (cell & SIM_WEST) out->v_walls[x] |= 1u << y;
+            if (cell & SIM_EAST) out->v_walls[x + 1] |= 1u << y;
+        }
+    }
+    if (sim->has_goal) {
+        out->flags |= CORPUS_HAS_GOAL;
+        memcpy(out->goal_rows, sim->goal_rows, sizeof(out->goal_rows));
+    }
+}
+
+bool corpus_write(const char *path, const CorpusMaze *mazes, uint32_t count) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) return false;
+
+    CorpusHeader header = {{0}, CORPUS_VERSION, sizeof(CorpusMaze), count, 0};
+    memcpy(header.magic, CORPUS_MAGIC, 4);
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(mazes, sizeof(CorpusMaze), count, file) == count;
+    return fclose(file) == 0 && ok;
+}
+
+// --- Reading ---
+
+bool corpus_is_file(const char *path) {
+    char magic[4];
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return false;
+    bool ok = fread(magic, 4, 1, file) == 1 && memcmp(magic, CORPUS_MAGIC, 4) == 0;
+    fclose(file);
+    return ok;
+}
+
+bool corpus_open(Corpus *c, const char *path) {
+    memset(c, 0, sizeof(*c));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CorpusHeader)) {
+        fprintf(stderr, "%s: not a maze corpus\n", path);
+        close(fd);
+        return false;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping keeps the file open
+    if (map == MAP_FAILED) {
+        perror(path);
+        return false;
+    }
+
+    const CorpusHeader *header = map;
+    if (memcmp(header->magic, CORPUS_MAGIC, 4) != 0 || header->version != CORPUS_VERSION ||
+        header->record_size != sizeof(CorpusMaze) ||
+        (size_t)st.st_size < sizeof(CorpusHeader) + (size_t)header->count * sizeof(CorpusMaze)) {
+        fprintf(stderr, "%s: not a version %d maze corpus or cut off\n", path, CORPUS_VERSION);
+        munmap(map, (size_t)st.st_size);
+        return false;
+    }
+    c->mazes = (const CorpusMaze *)(header + 1);
+    c->count = header->count;
+    c->map = map;
+    c->map_size = (size_t)st.st_size;
+    return true;
+}
+
+void corpus_close(Corpus *c) {
+    if (c->map) munmap(c->map, c->map_size);
+    memset(c, 0, sizeof(*c));
+}
+
+// Only the header is checked on open, a record is checked when it is used
+static bool record_ok(const CorpusMaze *m) {
+    return m->width >= 1 && m->width <= SIM_MAX_SIZE && m->height >= 1 && m->height <= SIM_MAX_SIZE &&
+           memchr(m->name, '\0', sizeof(m->name)) != NULL;
+}
+
+const CorpusMaze *corpus_maze(const Corpus *c, long id) {
+    return id >= 0 && id < (long)c->count && record_ok(&c->mazes[id]) ? &c->mazes[id] : NULL;
+}
+
+long corpus_find(const Corpus *c, const char *name) {
+    for (uint32_t i = 0; i < c->count; i++) {
+        if (strncmp(c->mazes[i].name, name, CORPUS_NAME_SIZE) == 0) return (long)i;
+    }
+    return -1;
+}
+
+bool corpus_sim(const CorpusMaze *m, Sim *sim) {
+    if (!record_ok(m)) return false;
+    sim_init(sim, m->width, m->height);
+    for (int x = 0; x < m->width; x++) {
+        for (int y = 0; y < m->height; y++) {
+            unsigned char cell = 0;
+            if (m->h_walls[y + 1] >> x & 1) cell |= SIM_NORTH;
+            if (m->v_walls[x + 1] >> y & 1) cell |= SIM_EAST;
+            if (m->h_walls[y] >> x & 1) cell |= SIM_SOUTH;
+            if (m->v_walls[x] >> y & 1) cell |= SIM_WEST;
+            sim->walls[x][y] = cell;
+        }
+    }
+    if (m->flags & CORPUS_HAS_GOAL) {
+        memcpy(sim->goal_rows, m->goal_rows, sizeof(sim->goal_rows));
+        sim->has_goal = true;
+    }
+    return true;
+}
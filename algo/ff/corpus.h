@@ -0,0 +1,71 @@
+#pragma once
+#include "sim.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// corpus.h
+// Packed maze corpus for large evaluations: every maze as one fixed-size
+// record of bit-packed walls, goal mask and name, so a file of thousands of
+// mazes is mapped read-only once and maze id i is the i-th record. Workers
+// and processes share the mapping through the page cache and turn a record
+// into a Sim with a few loops, no file parsing. tools/ffpack.c writes one
+// from a maze directory.
+//
+//   0   CorpusHeader: "FFMZ", version, record size, maze count
+//   16  CorpusMaze records, in id order (ffpack sorts them by name)
+//
+// Walls are stored once per segment, both cells that share it see it. All
+// fields are little-endian, the host order of every machine that runs the
+// tools.
+
+#define CORPUS_MAGIC "FFMZ"
+#define CORPUS_VERSION 1
+#define CORPUS_NAME_SIZE 48
+
+#define CORPUS_HAS_GOAL 0x01 // goal_rows replaces the centre goal, as Sim.has_goal
+
+typedef struct {
+    char magic[4];        // CORPUS_MAGIC
+    uint16_t version;     // CORPUS_VERSION
+    uint16_t record_size; // sizeof(CorpusMaze), rejected on open if it differs
+    uint32_t count;
+    uint32_t reserved;
+} CorpusHeader;
+
+typedef struct {
+    uint8_t width, height;
+    uint8_t flags; // CORPUS_HAS_* bits
+    uint8_t reserved;
+    uint32_t h_walls[SIM_MAX_SIZE + 1]; // Bit x of row y: wall on the south side of (x,y), row height the top edge
+    uint32_t v_walls[SIM_MAX_SIZE + 1]; // Bit y of column x: wall on the west side of (x,y), column width the east edge
+    uint32_t goal_rows[SIM_MAX_SIZE];   // Bit x of row y, if CORPUS_HAS_GOAL
+    char name[CORPUS_NAME_SIZE];        // Maze file name without the directory, NUL terminated
+} CorpusMaze;
+
+typedef struct {
+    const CorpusMaze *mazes; // Inside the mapping, read-only
+    uint32_t count;
+    void *map;
+    size_t map_size;
+} Corpus;
+
+// --- Writing ---
+void corpus_pack(const Sim *sim, const char *name, CorpusMaze *out); // name is truncated to fit
+bool corpus_write(const char *path, const CorpusMaze *mazes, uint32_t count);
+
+// --- Reading ---
+
+// Maps the corpus at path read-only. Returns false, with an error on stderr,
+// if it cannot be mapped or is not a version CORPUS_VERSION corpus
+bool corpus_open(Corpus *c, const char *path);
+void corpus_close(Corpus *c);
+bool corpus_is_file(const char *path); // Starts with CORPUS_MAGIC
+
+const CorpusMaze *corpus_maze(const Corpus *c, long id); // NULL if id is out of range or the record is damaged
+long corpus_find(const Corpus *c, const char *name);     // Id of the maze called name, -1 if none
+
+// Sets sim up like sim_load_file would for the maze file the record was packed
+// from. Returns false, leaving sim alone, if the record's size is not 1 to
+// SIM_MAX_SIZE or its name is not terminated
+bool corpus_sim(const CorpusMaze *m, Sim *sim);
@@ -0,0 +1,93 @@
+// display.c
+// shadow-diffing implementation of display.h on top of api.h
+
+#define _POSIX_C_SOURCE 200809L
+#include "display.h"
+#include "api.h"
+#include <string.h>
+
+static DisplayShadow displayShadow;
+
+static int displayInBounds(int x, int y) {
+  return x >= 0 && x < DISPLAY_MAX_WIDTH && y >= 0 && y < DISPLAY_MAX_HEIGHT;
+}
+
+static unsigned char displayWallBit(char direction) {
+  switch (direction) {
+  case 'n':
+    return 1;
+  case 'e':
+    return 2;
+  case 's':
+    return 4;
+  default:
+    return 8;
+  }
+}
+
+void DISPLAY_setText(int x, int y, char *text) {
+  if (!displayInBounds(x, y)) {
+    API_setText(x, y, text);
+    return;
+  }
+  char *shadow = displayShadow.text[x][y];
+  if (strncmp(shadow, text, DISPLAY_TEXT_SIZE) == 0) {
+    return;
+  }
+  size_t length = strnlen(text, DISPLAY_TEXT_SIZE - 1);
+  memcpy(shadow, text, length);
+  shadow[length] = '\0';
+  API_setText(x, y, text);
+}
+
+void DISPLAY_setColor(int x, int y, char color) {
+  if (!displayInBounds(x, y)) {
+    API_setColor(x, y, color);
+    return;
+  }
+  if (displayShadow.color[x][y] == color) {
+    return;
+  }
+  displayShadow.color[x][y] = color;
+  API_setColor(x, y, color);
+}
+
+void DISPLAY_setWall(int x, int y, char direction) {
+  if (!displayInBounds(x, y)) {
+    API_setWall(x, y, direction);
+    return;
+  }
+  unsigned char bit = displayWallBit(direction);
+  if (displayShadow.walls[x][y] & bit) {
+    return;
+  }
+  displayShadow.walls[x][y] |= bit;
+  API_setWall(x, y, direction);
+}
+
+void DISPLAY_clearWall(int x, int y, char direction) {
+  if (!displayInBounds(x, y)) {
+    API_clearWall(x, y, direction);
+    return;
+  }
+  unsigned char bit = displayWallBit(direction);
+  if (!(displayShadow.walls[x][y] & bit)) {
+    return;
+  }
+  displayShadow.walls[x][y] &= ~bit;
+  API_clearWall(x, y, direction);
+}
+
+void DISPLAY_reset() {
+  const char directions[4] = {'n', 'e', 's', 'w'};
+  for (int x = 0; x < DISPLAY_MAX_WIDTH; x++) {
+    for (int y = 0; y < DISPLAY_MAX_HEIGHT; y++) {
+      for (int i = 0; i < 4; i++) {
+        DISPLAY_clearWall(x, y, directions[i]);
+      }
+    }
+  }
+  API_clearAllColor();
+  API_clearAllText();
+  memset(&displayShadow, 0, sizeof(displayShadow));
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+// display.h
+// diffing layer over the mms drawing commands.
+// keeps a shadow copy of the text, color and walls last sent for every cell
+// and only forwards a command to mms when the cell actually changes, so a
+// full repaint every step costs a handful of commands instead of ~1500.
+
+// large enough for half-size (32x32) mazes, cells beyond it are sent undiffed
+#define DISPLAY_MAX_WIDTH 32
+#define DISPLAY_MAX_HEIGHT 32
+#define DISPLAY_TEXT_SIZE 8
+
+typedef struct {
+  char text[DISPLAY_MAX_WIDTH][DISPLAY_MAX_HEIGHT][DISPLAY_TEXT_SIZE];
+  char color[DISPLAY_MAX_WIDTH][DISPLAY_MAX_HEIGHT]; // 0 when never set
+  unsigned char walls[DISPLAY_MAX_WIDTH][DISPLAY_MAX_HEIGHT]; // one bit per n/e/s/w
+} DisplayShadow;
+
+void DISPLAY_setText(int x, int y, char *text);
+void DISPLAY_setColor(int x, int y, char color);
+void DISPLAY_setWall(int x, int y, char direction);
+void DISPLAY_clearWall(int x, int y, char direction);
+
+// wipes everything drawn so far (e.g. after a simulator reset) and forgets
+// the shadow so the next update repaints from scratch
+void DISPLAY_reset();
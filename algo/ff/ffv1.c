@@ -4,6 +4,7 @@
 /// it successfully solves the maze but doesn't have the speed run part
 
 #include "api.h"
+#include "display.h"
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -66,7 +67,7 @@ int main(int argc, char *argv[]) {
     // check if we've reached the goal
     if (isAtGoal()) {
       logMessage("=== goal reached! ===");
-      API_setColor(posX, posY, 'G');
+      DISPLAY_setColor(posX, posY, 'G');
       break;
     }
 
@@ -169,6 +170,8 @@ void updateWalls(void) {
 }
 
 void floodFill(void) {
+  API_floodFillBegin();
+
   // create queue for bfs
   typedef struct {
     int x, y;
@@ -222,6 +225,7 @@ void floodFill(void) {
       }
     }
   }
+  API_floodFillEnd();
 }
 
 bool isAtGoal(void) {
@@ -307,18 +311,18 @@ void updateDisplay(void) {
       // set the text to show distance
       char buffer[8];
       sprintf(buffer, "%d", distances[x][y]);
-      API_setText(x, y, buffer);
+      DISPLAY_setText(x, y, buffer);
 
       // set cell color
       if (x == posX && y == posY) {
-        API_setColor(x, y, 'r'); // current cell: red
+        DISPLAY_setColor(x, y, 'r'); // current cell: red
       } else if ((x == GOAL_X1 || x == GOAL_X2) &&
                  (y == GOAL_Y1 || y == GOAL_Y2)) {
-        API_setColor(x, y, 'G'); // goal cells: green
+        DISPLAY_setColor(x, y, 'G'); // goal cells: green
       } else if (visited[x][y]) {
-        API_setColor(x, y, 'B'); // visited cells: blue
+        DISPLAY_setColor(x, y, 'B'); // visited cells: blue
       } else {
-        API_setColor(x, y, 'Y'); // unvisited cells: yellow
+        DISPLAY_setColor(x, y, 'Y'); // unvisited cells: yellow
       }
     }
   }
@@ -328,16 +332,16 @@ void updateDisplay(void) {
     for (int y = 0; y < MAZE_HEIGHT; y++) {
       // mark walls on the api map
       if (walls[x][y][NORTH]) {
-        API_setWall(x, y, 'n');
+        DISPLAY_setWall(x, y, 'n');
       }
       if (walls[x][y][EAST]) {
-        API_setWall(x, y, 'e');
+        DISPLAY_setWall(x, y, 'e');
       }
       if (walls[x][y][SOUTH]) {
-        API_setWall(x, y, 's');
+        DISPLAY_setWall(x, y, 's');
       }
       if (walls[x][y][WEST]) {
-        API_setWall(x, y, 'w');
+        DISPLAY_setWall(x, y, 'w');
       }
     }
   }
@@ -1,4 +1,5 @@
 #include "api.h"
+#include "display.h"
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -79,8 +80,9 @@ int main(int argc, char *argv[]) {
       goalFound = false;
       pathLength = 0;
 
-      // Reinitialize the maze
+      // Reinitialize the maze and repaint it from scratch
       initializeMaze();
+      DISPLAY_reset();
     }
     // update our knowledge of the maze
     updateWalls();
@@ -249,6 +251,8 @@ void updateWalls(void) {
 
 // Generalized flood fill to any target
 void floodFill(int targetX, int targetY) {
+  API_floodFillBegin();
+
   // create queue for BFS
   typedef struct {
     int x, y;
@@ -300,6 +304,7 @@ void floodFill(int targetX, int targetY) {
       }
     }
   }
+  API_floodFillEnd();
 }
 
 // Flood fill with goal as the target
@@ -711,7 +716,7 @@ void followShortestPath(void) {
   }
 
   // Mark the goal as reached
-  API_setColor(posX, posY, 'G');
+  DISPLAY_setColor(posX, posY, 'G');
   logMessage("=== Speed run complete! Goal reached! ===");
 }
 
@@ -722,29 +727,31 @@ void updateDisplay(void) {
       // set the text to show distance
       char buffer[8];
       sprintf(buffer, "%d", distances[x][y]);
-      API_setText(x, y, buffer);
+      DISPLAY_setText(x, y, buffer);
 
-      // set cell color
+      // pick the cell color, sent once so unchanged cells cost nothing
+      char color;
       if (x == posX && y == posY) {
-        API_setColor(x, y, 'r'); // current cell: red
+        color = 'r'; // current cell: red
       } else if ((x == GOAL_X1 || x == GOAL_X2) &&
                  (y == GOAL_Y1 || y == GOAL_Y2)) {
-        API_setColor(x, y, 'G'); // goal cells: green
+        color = 'G'; // goal cells: green
       } else if (visited[x][y]) {
-        API_setColor(x, y, 'B'); // visited cells: blue
+        color = 'B'; // visited cells: blue
       } else {
-        API_setColor(x, y, 'Y'); // unvisited cells: yellow
+        color = 'Y'; // unvisited cells: yellow
       }
 
       // Highlight the shortest path in speed mode
       if (currentMode == SPEED_MODE) {
         for (int i = 0; i < pathLength; i++) {
           if (x == fastestPath[i][0] && y == fastestPath[i][1]) {
-            API_setColor(x, y, 'C'); // path: cyan
+            color = 'C'; // path: cyan
             break;
           }
         }
       }
+      DISPLAY_setColor(x, y, color);
     }
   }
 
@@ -753,16 +760,16 @@ void updateDisplay(void) {
     for (int y = 0; y < MAZE_HEIGHT; y++) {
       // mark walls on the api map
       if (walls[x][y][NORTH]) {
-        API_setWall(x, y, 'n');
+        DISPLAY_setWall(x, y, 'n');
       }
       if (walls[x][y][EAST]) {
-        API_setWall(x, y, 'e');
+        DISPLAY_setWall(x, y, 'e');
       }
       if (walls[x][y][SOUTH]) {
-        API_setWall(x, y, 's');
+        DISPLAY_setWall(x, y, 's');
       }
       if (walls[x][y][WEST]) {
-        API_setWall(x, y, 'w');
+        DISPLAY_setWall(x, y, 'w');
       }
     }
   }
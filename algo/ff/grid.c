@@ -0,0 +1,76 @@
+#include "grid.h"
+#include <string.h>
+
+const int16_t grid_offset[DIRECTION_COUNT] = {
+    GRID_STRIDE,  // NORTH
+    1,            // EAST
+    -GRID_STRIDE, // SOUTH
+    -1            // WEST
+};
+
+const uint8_t grid_rotation[DIRECTION_COUNT][DIRECTION_COUNT] = {
+    {NORTH, EAST, SOUTH, WEST},
+    {EAST, SOUTH, WEST, NORTH},
+    {SOUTH, WEST, NORTH, EAST},
+    {WEST, NORTH, EAST, SOUTH},
+};
+
+const uint8_t grid_quarter_turns[DIRECTION_COUNT][DIRECTION_COUNT] = {
+    {0, 1, 2, 3},
+    {3, 0, 1, 2},
+    {2, 3, 0, 1},
+    {1, 2, 3, 0},
+};
+
+// Empty width x height maze: sentinel border, outer walls and the default goal,
+// the centre 2x2 (a single cell across an odd dimension) like mms.
+// Returns false if the size is below 3x3 or does not fit the compiled capacity.
+bool grid_init(CellGraph *g, int width, int height) {
+    // Up to 2x2 the centre goal covers the start cell
+    if (width < 3 || width > MAZE_MAX_WIDTH || height < 3 || height > MAZE_MAX_HEIGHT) return false;
+
+    g->width = width;
+    g->height = height;
+    memset(g->flags, GRID_BORDER | GRID_WALLS, sizeof(g->flags));
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) {
+            uint8_t flags = 0;
+            if (y == height - 1) flags |= 1 << NORTH;
+            if (x == width - 1) flags |= 1 << EAST;
+            if (y == 0) flags |= 1 << SOUTH;
+            if (x == 0) flags |= 1 << WEST;
+            if (x >= (width - 1) / 2 && x <= width / 2 && y >= (height - 1) / 2 && y <= height / 2) {
+                flags |= GRID_GOAL;
+            }
+            g->flags[grid_index((Point){x, y})] = flags;
+        }
+    }
+    return true;
+}
+
+// Walls are shared, so the neighbour gets the opposite side too
+void grid_set_wall(CellGraph *g, CellIndex c, Direction dir) {
+    g->flags[c] |= (uint8_t)(1 << dir);
+    g->flags[grid_neighbor(c, dir)] |= (uint8_t)(1 << grid_rotate(dir, 2));
+}
+
+void grid_set_goal(CellGraph *g, CellIndex c, bool goal) {
+    g->flags[c] = (uint8_t)(goal ? g->flags[c] | GRID_GOAL : g->flags[c] & ~GRID_GOAL);
+}
+
+// Only for undoing a hypothetical wall, sensed walls are never cleared
+void grid_clear_wall(CellGraph *g, CellIndex c, Direction dir) {
+    g->flags[c] &= (uint8_t)~(1 << dir);
+    g->flags[grid_neighbor(c, dir)] &= (uint8_t)~(1 << grid_rotate(dir, 2));
+}
+
+// Finds the direction that leads from one cell to an adjacent one
+bool grid_direction_between(CellIndex from, CellIndex to, Direction *dir) {
+    for (Direction d = 0; d < DIRECTION_COUNT; d++) {
+        if (grid_neighbor(from, d) == to) {
+            *dir = d;
+            return true;
+        }
+    }
+    return false;
+}
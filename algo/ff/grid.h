@@ -0,0 +1,136 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// grid.h
+// Cell graph shared by the flood fills, the path planner and the path checks.
+// Cells are numbered linearly over a (MAZE_MAX_WIDTH+2) x (MAZE_MAX_HEIGHT+2) grid
+// whose outer ring is a sentinel border, so every maze cell has its four
+// neighbours at fixed index offsets. The outer maze walls are always set, which
+// stops any walk before it reaches the border: neighbour loops need no bounds
+// checks, only a wall test against the cell's flag byte.
+//
+// The actual maze size is set at runtime (grid_init) and may be anything from
+// 3x3 up to the compiled capacity; cells beyond it are border. Offsets depend
+// only on the capacity, so the search loops are as fast as with a hard-coded
+// size.
+
+// --- Constants ---
+// Capacity of a build. Classic 16x16 by default, -DMAZE_MAX_SIZE=32 for half-size
+#ifndef MAZE_MAX_SIZE
+#define MAZE_MAX_SIZE 16
+#endif
+#if MAZE_MAX_SIZE < 3 || MAZE_MAX_SIZE > 32
+#error "MAZE_MAX_SIZE must be 3..32, maze rows are bitboards of at most 32 cells"
+#endif
+#define MAZE_MAX_WIDTH MAZE_MAX_SIZE
+#define MAZE_MAX_HEIGHT MAZE_MAX_SIZE
+#define MAX_CELLS (MAZE_MAX_WIDTH * MAZE_MAX_HEIGHT)
+
+#define GRID_STRIDE (MAZE_MAX_WIDTH + 2)
+#define GRID_CELLS (GRID_STRIDE * (MAZE_MAX_HEIGHT + 2))
+
+// Cell flag byte: bit `dir` is set when that side is walled
+#define GRID_WALLS 0x0F
+#define GRID_GOAL 0x10   // Cell is part of the goal area
+#define GRID_BORDER 0x20 // Sentinel outside the maze
+#define GRID_VISITED 0x40 // Mouse has stood here, so all four sides are known
+
+// --- Enums ---
+typedef enum {
+    NORTH = 0,
+    EAST = 1,
+    SOUTH = 2,
+    WEST = 3,
+    DIRECTION_COUNT = 4 // Helper for loops/arrays
+} Direction;
+
+// What is known about one side of a cell
+typedef enum {
+    WALL_UNKNOWN, // Never sensed: open to the optimistic planner, closed to the known-only one
+    WALL_OPEN,
+    WALL_PRESENT
+} WallState;
+
+// --- Structs ---
+
+// Represents a coordinate point
+typedef struct {
+    int x;
+    int y;
+} Point;
+
+// Linear index of a cell in the padded grid
+typedef uint16_t CellIndex;
+
+typedef struct {
+    int width;                 // Maze size in cells, at most the capacity
+    int height;
+    uint8_t flags[GRID_CELLS]; // GRID_* bits per cell
+} CellGraph;
+
+// Index offsets of the neighbour in each direction, same order as Direction
+extern const int16_t grid_offset[DIRECTION_COUNT];
+// Heading arithmetic as table loads: grid_rotation[dir][n] is dir after n quarter
+// turns right (3 = one left), grid_quarter_turns[from][to] the right turns between
+extern const uint8_t grid_rotation[DIRECTION_COUNT][DIRECTION_COUNT];
+extern const uint8_t grid_quarter_turns[DIRECTION_COUNT][DIRECTION_COUNT];
+
+// --- Indexing ---
+static inline CellIndex grid_index(Point p) {
+    return (CellIndex)((p.y + 1) * GRID_STRIDE + p.x + 1);
+}
+
+static inline Point grid_point(CellIndex c) {
+    return (Point){c % GRID_STRIDE - 1, c / GRID_STRIDE - 1};
+}
+
+static inline CellIndex grid_neighbor(CellIndex c, Direction dir) {
+    return (CellIndex)(c + grid_offset[dir]);
+}
+
+static inline Direction grid_rotate(Direction dir, int quarter_turns) {
+    return (Direction)grid_rotation[dir][quarter_turns];
+}
+
+static inline int grid_turns_between(Direction from, Direction to) {
+    return grid_quarter_turns[from][to];
+}
+
+// --- Queries ---
+static inline bool grid_contains(const CellGraph *g, Point p) {
+    return p.x >= 0 && p.x < g->width && p.y >= 0 && p.y < g->height;
+}
+
+static inline bool grid_has_wall(const CellGraph *g, CellIndex c, Direction dir) {
+    return (g->flags[c] >> dir) & 1;
+}
+
+static inline bool grid_is_goal(const CellGraph *g, CellIndex c) {
+    return g->flags[c] & GRID_GOAL;
+}
+
+// A side has been sensed once the mouse stood on either of its cells
+static inline bool grid_is_known(const CellGraph *g, CellIndex c, Direction dir) {
+    return (g->flags[c] | g->flags[grid_neighbor(c, dir)]) & GRID_VISITED;
+}
+
+// The wall bits alone cannot tell an open side from one never looked at, the
+// visited bits of the two cells can. Walls from any source are present
+static inline WallState grid_wall_state(const CellGraph *g, CellIndex c, Direction dir) {
+    if (grid_has_wall(g, c, dir)) return WALL_PRESENT;
+    return grid_is_known(g, c, dir) ? WALL_OPEN : WALL_UNKNOWN;
+}
+
+// Whether a planned path may cross the side: known open, or also unknown unless known_only
+static inline bool grid_can_cross(const CellGraph *g, CellIndex c, Direction dir, bool known_only) {
+    WallState state = grid_wall_state(g, c, dir);
+    return state == WALL_OPEN || (state == WALL_UNKNOWN && !known_only);
+}
+
+// --- Setup and Updates ---
+bool grid_init(CellGraph *g, int width, int height);
+void grid_set_wall(CellGraph *g, CellIndex c, Direction dir);
+void grid_set_goal(CellGraph *g, CellIndex c, bool goal);
+void grid_clear_wall(CellGraph *g, CellIndex c, Direction dir);
+bool grid_direction_between(CellIndex from, CellIndex to, Direction *dir);
@@ -0,0 +1,108 @@
+// io_api.c
+// MouseIO backend over the API_* functions in api.h, so the solver core runs
+// on whichever API implementation is linked: api.c (mms) or api_sim.c
+// (headless). Drawing goes through the display.h diffing layer.
+
+#include "api.h"
+#include "display.h"
+#include "mouse_io.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int api_io_maze_width(void *ctx) { return API_mazeWidth(); }
+static int api_io_maze_height(void *ctx) { return API_mazeHeight(); }
+static bool api_io_wall_front(void *ctx) { return API_wallFront(); }
+static bool api_io_wall_right(void *ctx) { return API_wallRight(); }
+static bool api_io_wall_left(void *ctx) { return API_wallLeft(); }
+static uint8_t api_io_read_walls(void *ctx) { return (uint8_t)API_readWalls(); }
+static bool api_io_move_forward(void *ctx) { return API_moveForward(); }
+static bool api_io_move_forward_n(void *ctx, int cells) { return API_moveForwardN(cells); }
+static void api_io_turn_right(void *ctx) { API_turnRight(); }
+static void api_io_turn_left(void *ctx) { API_turnLeft(); }
+static bool api_io_move_half(void *ctx) { return API_moveHalf(); }
+static bool api_io_move_diagonal(void *ctx, int segments) { return API_moveDiagonal(segments); }
+static void api_io_turn_right_45(void *ctx) { API_turnRight45(); }
+static void api_io_turn_left_45(void *ctx) { API_turnLeft45(); }
+static void api_io_start_forward(void *ctx) { API_moveForwardStart(); }
+static bool api_io_finish_forward(void *ctx) { return API_moveForwardFinish(); }
+static bool api_io_walls_ahead(void *ctx, uint8_t *walls) {
+    int bits = 0;
+    if (!API_wallsAhead(&bits)) return false;
+    *walls = (uint8_t)bits;
+    return true;
+}
+
+static bool api_io_is_goal(void *ctx, int x, int y) { return API_isGoal(x, y); }
+
+static bool api_io_was_reset(void *ctx) { return API_wasReset(); }
+static void api_io_ack_reset(void *ctx) { API_ackReset(); }
+
+static void api_io_set_wall(void *ctx, int x, int y, char direction) { DISPLAY_setWall(x, y, direction); }
+static void api_io_set_color(void *ctx, int x, int y, char color) { DISPLAY_setColor(x, y, color); }
+static void api_io_set_text(void *ctx, int x, int y, const char *text) { DISPLAY_setText(x, y, (char *)text); }
+static void api_io_clear_display(void *ctx) { DISPLAY_reset(); }
+
+// Map persistence in the file named by SOLVER_MAP_FILE, installed only if it is set
+static bool api_io_save_map(void *ctx, const uint8_t *image, int size) {
+    FILE *file = fopen(getenv("SOLVER_MAP_FILE"), "wb");
+    if (file == NULL) return false;
+    bool ok = fwrite(image, 1, (size_t)size, file) == (size_t)size;
+    return fclose(file) == 0 && ok;
+}
+
+static int api_io_load_map(void *ctx, uint8_t *image, int capacity) {
+    FILE *file = fopen(getenv("SOLVER_MAP_FILE"), "rb");
+    if (file == NULL) return 0;
+    int size = (int)fread(image, 1, (size_t)capacity, file);
+    fclose(file);
+    return size;
+}
+
+static void api_io_flood_fill_begin(void *ctx) { API_floodFillBegin(); }
+static void api_io_flood_fill_end(void *ctx) { API_floodFillEnd(); }
+
+static MouseIO api_io_hooks = {
+    .ctx = NULL, // api.h keeps its own global state
+    .maze_width = api_io_maze_width,
+    .maze_height = api_io_maze_height,
+    .wall_front = api_io_wall_front,
+    .wall_right = api_io_wall_right,
+    .wall_left = api_io_wall_left,
+    .read_walls = api_io_read_walls,
+    .move_forward = api_io_move_forward,
+    .turn_right = api_io_turn_right,
+    .turn_left = api_io_turn_left,
+    .move_forward_n = api_io_move_forward_n,
+    .was_reset = api_io_was_reset,
+    .ack_reset = api_io_ack_reset,
+    .set_wall = api_io_set_wall,
+    .set_color = api_io_set_color,
+    .set_text = api_io_set_text,
+    .clear_display = api_io_clear_display,
+    .flood_fill_begin = api_io_flood_fill_begin,
+    .flood_fill_end = api_io_flood_fill_end,
+};
+
+// The diagonal, split-move, walls-ahead and goal hooks stay NULL unless the linked
+// API has them, the map hooks unless SOLVER_MAP_FILE names a file
+const MouseIO *api_io(void) {
+    if (API_hasDiagonals()) {
+        api_io_hooks.move_half = api_io_move_half;
+        api_io_hooks.turn_right_45 = api_io_turn_right_45;
+        api_io_hooks.turn_left_45 = api_io_turn_left_45;
+        api_io_hooks.move_diagonal = api_io_move_diagonal;
+    }
+    if (API_hasMoveStart()) {
+        api_io_hooks.start_forward = api_io_start_forward;
+        api_io_hooks.finish_forward = api_io_finish_forward;
+        if (API_hasWallsAhead()) api_io_hooks.walls_ahead = api_io_walls_ahead;
+    }
+    if (API_hasGoalCells()) api_io_hooks.is_goal = api_io_is_goal;
+    const char *map_file = getenv("SOLVER_MAP_FILE");
+    if (map_file != NULL && *map_file) {
+        api_io_hooks.save_map = api_io_save_map;
+        api_io_hooks.load_map = api_io_load_map;
+    }
+    return &api_io_hooks;
+}
@@ -0,0 +1,79 @@
+// io_stm32.c
+// MouseIO backend for the STM32 micromouse. The board support package
+// provides the bsp_* hooks below on top of the HAL (IR sensor thresholds,
+// motion profiles over the encoders); this file only adapts them to MouseIO.
+// There is no display, and a flood fill is too short to be worth timing here.
+
+#include "mouse_io.h"
+#include <stddef.h>
+
+// Implemented by the board support package
+extern bool bsp_wall_front(void);
+extern bool bsp_wall_right(void);
+extern bool bsp_wall_left(void);
+extern uint8_t bsp_read_walls(void); // All three thresholds from one sample, MOUSE_WALL_* bits
+extern bool bsp_move_forward(void); // One cell, false if the front sensor stopped the move
+extern bool bsp_move_straight(int cells); // One trapezoidal profile over several cells
+extern void bsp_turn_right(void);   // 90 degrees in place
+extern void bsp_turn_left(void);
+extern void bsp_move_forward_start(void);  // One cell, driven by the control loop interrupt
+extern bool bsp_move_forward_finish(void); // Waits for it, false if the front sensor stopped it
+extern bool bsp_walls_ahead(uint8_t *walls); // Latched by the sampling interrupt once the side sensors cross the cell entry
+extern bool bsp_move_half(void);    // Half a cell, centre to edge midpoint or back
+extern bool bsp_move_diagonal(int segments); // One profile over several half-diagonals
+extern void bsp_turn_right_45(void); // 45 degrees in place
+extern void bsp_turn_left_45(void);
+extern bool bsp_flash_write_map(const uint8_t *image, int size); // Erase + program the map sector
+extern int bsp_flash_read_map(uint8_t *image, int capacity);     // Bytes read, 0 if the sector is blank
+
+// Competition maze, the board has no way to sense its size (32 for half-size contests)
+#ifndef STM32_MAZE_SIZE
+#define STM32_MAZE_SIZE 16
+#endif
+
+static int stm32_io_maze_width(void *ctx) { return STM32_MAZE_SIZE; }
+static int stm32_io_maze_height(void *ctx) { return STM32_MAZE_SIZE; }
+static bool stm32_io_wall_front(void *ctx) { return bsp_wall_front(); }
+static bool stm32_io_wall_right(void *ctx) { return bsp_wall_right(); }
+static bool stm32_io_wall_left(void *ctx) { return bsp_wall_left(); }
+static uint8_t stm32_io_read_walls(void *ctx) { return bsp_read_walls(); }
+static bool stm32_io_move_forward(void *ctx) { return bsp_move_forward(); }
+static bool stm32_io_move_forward_n(void *ctx, int cells) { return bsp_move_straight(cells); }
+static void stm32_io_turn_right(void *ctx) { bsp_turn_right(); }
+static void stm32_io_turn_left(void *ctx) { bsp_turn_left(); }
+static void stm32_io_start_forward(void *ctx) { bsp_move_forward_start(); }
+static bool stm32_io_finish_forward(void *ctx) { return bsp_move_forward_finish(); }
+static bool stm32_io_walls_ahead(void *ctx, uint8_t *walls) { return bsp_walls_ahead(walls); }
+static bool stm32_io_move_half(void *ctx) { return bsp_move_half(); }
+static bool stm32_io_move_diagonal(void *ctx, int segments) { return bsp_move_diagonal(segments); }
+static void stm32_io_turn_right_45(void *ctx) { bsp_turn_right_45(); }
+static void stm32_io_turn_left_45(void *ctx) { bsp_turn_left_45(); }
+static bool stm32_io_save_map(void *ctx, const uint8_t *image, int size) { return bsp_flash_write_map(image, size); }
+static int stm32_io_load_map(void *ctx, uint8_t *image, int capacity) { return bsp_flash_read_map(image, capacity); }
+
+static const MouseIO stm32_io_hooks = {
+    .ctx = NULL,
+    .maze_width = stm32_io_maze_width,
+    .maze_height = stm32_io_maze_height,
+    .wall_front = stm32_io_wall_front,
+    .wall_right = stm32_io_wall_right,
+    .wall_left = stm32_io_wall_left,
+    .read_walls = stm32_io_read_walls,
+    .move_forward = stm32_io_move_forward,
+    .turn_right = stm32_io_turn_right,
+    .turn_left = stm32_io_turn_left,
+    .move_forward_n = stm32_io_move_forward_n,
+    .start_forward = stm32_io_start_forward,
+    .finish_forward = stm32_io_finish_forward,
+    .walls_ahead = stm32_io_walls_ahead,
+    .move_half = stm32_io_move_half,
+    .turn_right_45 = stm32_io_turn_right_45,
+    .turn_left_45 = stm32_io_turn_left_45,
+    .move_diagonal = stm32_io_move_diagonal,
+    .save_map = stm32_io_save_map,
+    .load_map = stm32_io_load_map,
+};
+
+const MouseIO *stm32_io(void) {
+    return &stm32_io_hooks;
+}
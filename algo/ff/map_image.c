@@ -0,0 +1,107 @@
+#include "map_image.h"
+#include <string.h>
+
+static const uint8_t map_image_magic[4] = {'F', 'F', 'M', 'P'};
+
+// Bitwise CRC-32 (IEEE 802.3), a handful of bytes per save needs no table
+uint32_t map_image_crc32(const uint8_t *data, int size) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (int i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+// --- Row Packing ---
+
+static uint8_t *put_rows(uint8_t *out, const MazeRow *rows, int count, int bits) {
+    for (int i = 0; i < count; i++) {
+        for (int b = 0; b < MAP_ROW_BYTES(bits); b++) {
+            *out++ = (uint8_t)(rows[i] >> (8 * b));
+        }
+    }
+    return out;
+}
+
+static const uint8_t *get_row(const uint8_t *in, MazeRow *row, int bits) {
+    *row = 0;
+    for (int b = 0; b < MAP_ROW_BYTES(bits); b++) {
+        *row |= (MazeRow)((MazeRow)*in++ << (8 * b));
+    }
+    *row &= (MazeRow)((bits < (int)(8 * sizeof(MazeRow)) ? (1u << bits) : 0u) - 1u);
+    return in;
+}
+
+// --- Save / Load ---
+
+int map_image_save(const Maze *m, uint8_t *image, int capacity) {
+    int width = m->graph.width, height = m->graph.height;
+    int size = MAP_IMAGE_SIZE(width, height);
+    if (size > capacity) return 0;
+
+    memcpy(image, map_image_magic, sizeof(map_image_magic));
+    image[4] = MAP_IMAGE_VERSION;
+    image[5] = (uint8_t)width;
+    image[6] = (uint8_t)height;
+    image[7] = MAP_IMAGE_VISITED;
+
+    uint8_t *out = image + 8;
+    out = put_rows(out, m->h_walls, height + 1, width);
+    out = put_rows(out, m->v_walls, width + 1, height);
+    out = put_rows(out, m->visited, height, width);
+
+    uint32_t crc = map_image_crc32(image, (int)(out - image));
+    for (int b = 0; b < 4; b++) *out++ = (uint8_t)(crc >> (8 * b));
+    return size;
+}
+
+bool map_image_load(Maze *m, const uint8_t *image, int size, bool with_visited) {
+    int width = m->graph.width, height = m->graph.height;
+    if (size != MAP_IMAGE_SIZE(width, height) || memcmp(image, map_image_magic, sizeof(map_image_magic)) != 0 ||
+        image[4] != MAP_IMAGE_VERSION || image[5] != width || image[6] != height) {
+        return false;
+    }
+    uint32_t crc = 0;
+    for (int b = 0; b < 4; b++) crc |= (uint32_t)image[size - 4 + b] << (8 * b);
+    if (crc != map_image_crc32(image, size - 4)) return false;
+
+    // Replayed through set_wall so the cell graph and the wall log stay in step
+    const uint8_t *in = image + 8;
+    for (int y = 0; y <= height; y++) {
+        MazeRow row;
+        in = get_row(in, &row, width);
+        for (int x = 0; x < width; x++) {
+            if (!((row >> x) & 1)) continue;
+            if (y < height) {
+                set_wall(m, (Point){x, y}, SOUTH);
+            } else {
+                set_wall(m, (Point){x, height - 1}, NORTH);
+            }
+        }
+    }
+    for (int x = 0; x <= width; x++) {
+        MazeRow column;
+        in = get_row(in, &column, height);
+        for (int y = 0; y < height; y++) {
+            if (!((column >> y) & 1)) continue;
+            if (x < width) {
+                set_wall(m, (Point){x, y}, WEST);
+            } else {
+                set_wall(m, (Point){width - 1, y}, EAST);
+            }
+        }
+    }
+    if (with_visited && (image[7] & MAP_IMAGE_VISITED)) {
+        for (int y = 0; y < height; y++) {
+            MazeRow row;
+            in = get_row(in, &row, width);
+            for (int x = 0; x < width; x++) {
+                if ((row >> x) & 1) set_visited(m, (Point){x, y});
+            }
+        }
+    }
+    return true;
+}
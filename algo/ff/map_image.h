@@ -0,0 +1,36 @@
+#pragma once
+#include "solver.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// map_image.h
+// Compact, checksummed image of what a Maze has learned (wall segments and
+// visited cells), for keeping the map across resets and power cycles: a flash
+// sector on the mouse, a file on the host. The layout does not depend on the
+// build's MAZE_MAX_SIZE, so 16x16 images load into a 32x32 build and back.
+//
+//   0  "FFMP"
+//   4  version
+//   5  width, height
+//   7  flags (MAP_IMAGE_VISITED)
+//   8  h_walls rows 0..height, v_walls columns 0..width, visited rows 0..height-1,
+//      each as ceil(bits / 8) bytes, least significant bit first
+//   .. CRC-32 of everything before it, little-endian
+
+#define MAP_IMAGE_VERSION 1
+#define MAP_IMAGE_VISITED 0x01 // Visited rows are present
+
+#define MAP_ROW_BYTES(bits) (((bits) + 7) / 8)
+#define MAP_IMAGE_SIZE(w, h) \
+    (8 + (2 * (h) + 1) * MAP_ROW_BYTES(w) + ((w) + 1) * MAP_ROW_BYTES(h) + 4)
+#define MAP_IMAGE_MAX MAP_IMAGE_SIZE(MAZE_MAX_WIDTH, MAZE_MAX_HEIGHT)
+
+// Writes the image of m into image, returns its size (0 if capacity is too small)
+int map_image_save(const Maze *m, uint8_t *image, int capacity);
+
+// Replays the image's walls (and visited cells if with_visited) into m, which
+// must be freshly initialised to the same size. Returns false, leaving m
+// untouched, if the image is damaged or for another maze size.
+bool map_image_load(Maze *m, const uint8_t *image, int size, bool with_visited);
+
+uint32_t map_image_crc32(const uint8_t *data, int size);
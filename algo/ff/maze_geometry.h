@@ -0,0 +1,98 @@
+#pragma once
+#include "solver.h"
+
+// maze_geometry.h
+// Generated by tools/gengeometry.c for a 16x16 maze in a MAZE_MAX_SIZE=16 build, do not edit.
+// The state init_maze() and the first flood_fill_goal() produce, copied by
+// init_maze() when the solver is built with -DSOLVER_FIXED_GEOMETRY.
+
+#if MAZE_MAX_SIZE != 16
+#error "maze_geometry.h was generated for MAZE_MAX_SIZE=16, rerun tools/gengeometry.c"
+#endif
+
+#define GEOMETRY_WIDTH 16
+#define GEOMETRY_HEIGHT 16
+#define GEOMETRY_WALL_VERSION 64 // Outer wall segments, all logged
+
+// Cell flags by CellIndex: outer walls, goal mask, border
+static const uint8_t geometry_flags[GRID_CELLS] = {
+    0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F,
+    0x2F, 0x2F, 0x2F, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+    0x04, 0x04, 0x06, 0x2F, 0x2F, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x02, 0x2F, 0x2F, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x2F, 0x2F, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x2F, 0x2F, 0x08, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x2F, 0x2F, 0x08, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x2F, 0x2F, 0x08,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x2F,
+    0x2F, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x02, 0x2F, 0x2F, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x02, 0x2F, 0x2F, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x02, 0x2F, 0x2F, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x2F, 0x2F, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x2F, 0x2F, 0x08, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x2F, 0x2F, 0x08, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x2F, 0x2F, 0x08,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x2F,
+    0x2F, 0x09, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x03, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F,
+    0x2F, 0x2F, 0x2F, 0x2F,
+};
+
+// Goal cells by row, see Maze
+static const MazeRow geometry_goal[MAZE_MAX_HEIGHT] = {
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0180,
+    0x0180, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+};
+
+// Wall planes, see Maze
+static const MazeRow geometry_h_walls[MAZE_MAX_HEIGHT + 1] = {
+    0xFFFF, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0xFFFF,
+};
+
+static const MazeRow geometry_v_walls[MAZE_MAX_WIDTH + 1] = {
+    0xFFFF, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0xFFFF,
+};
+
+static const MazeRow geometry_e_walls[MAZE_MAX_HEIGHT] = {
+    0x8000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000,
+    0x8000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000,
+};
+
+// Maze.wall_log entries of the outer walls
+static const uint16_t geometry_wall_log[GEOMETRY_WALL_VERSION] = {
+    78, 1156, 82, 1160, 86, 1164, 90, 1168, 94, 1172, 98, 1176, 102, 1180, 106, 1184,
+    110, 1188, 114, 1192, 118, 1196, 122, 1200, 126, 1204, 130, 1208, 134, 1212, 138, 1216,
+    79, 137, 151, 209, 223, 281, 295, 353, 367, 425, 439, 497, 511, 569, 583, 641,
+    655, 713, 727, 785, 799, 857, 871, 929, 943, 1001, 1015, 1073, 1087, 1145, 1159, 1217,
+};
+
+// Goal distances on the empty maze, Manhattan distance to the goal area
+static const uint16_t geometry_goal_distances[GRID_CELLS] = {
+    256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256,
+    256, 256, 256, 14, 13, 12, 11, 10, 9, 8, 7, 7, 8, 9, 10, 11,
+    12, 13, 14, 256, 256, 13, 12, 11, 10, 9, 8, 7, 6, 6, 7, 8,
+    9, 10, 11, 12, 13, 256, 256, 12, 11, 10, 9, 8, 7, 6, 5, 5,
+    6, 7, 8, 9, 10, 11, 12, 256, 256, 11, 10, 9, 8, 7, 6, 5,
+    4, 4, 5, 6, 7, 8, 9, 10, 11, 256, 256, 10, 9, 8, 7, 6,
+    5, 4, 3, 3, 4, 5, 6, 7, 8, 9, 10, 256, 256, 9, 8, 7,
+    6, 5, 4, 3, 2, 2, 3, 4, 5, 6, 7, 8, 9, 256, 256, 8,
+    7, 6, 5, 4, 3, 2, 1, 1, 2, 3, 4, 5, 6, 7, 8, 256,
+    256, 7, 6, 5, 4, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5, 6,
+    7, 256, 256, 7, 6, 5, 4, 3, 2, 1, 0, 0, 1, 2, 3, 4,
+    5, 6, 7, 256, 256, 8, 7, 6, 5, 4, 3, 2, 1, 1, 2, 3,
+    4, 5, 6, 7, 8, 256, 256, 9, 8, 7, 6, 5, 4, 3, 2, 2,
+    3, 4, 5, 6, 7, 8, 9, 256, 256, 10, 9, 8, 7, 6, 5, 4,
+    3, 3, 4, 5, 6, 7, 8, 9, 10, 256, 256, 11, 10, 9, 8, 7,
+    6, 5, 4, 4, 5, 6, 7, 8, 9, 10, 11, 256, 256, 12, 11, 10,
+    9, 8, 7, 6, 5, 5, 6, 7, 8, 9, 10, 11, 12, 256, 256, 13,
+    12, 11, 10, 9, 8, 7, 6, 6, 7, 8, 9, 10, 11, 12, 13, 256,
+    256, 14, 13, 12, 11, 10, 9, 8, 7, 7, 8, 9, 10, 11, 12, 13,
+    14, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256,
+    256, 256, 256, 256,
+};
+
@@ -0,0 +1,91 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// mouse_io.h
+// Sensor, motion and display backend the solver core talks to.
+// Each backend (mms, headless simulator, STM32 HAL) fills one of these and
+// passes its own state through ctx, so the same compiled core runs on all
+// of them. Hooks marked optional may be NULL.
+
+// Wall reading bits of read_walls and walls_ahead, relative to the mouse's heading
+#define MOUSE_WALL_FRONT 0x01
+#define MOUSE_WALL_RIGHT 0x02
+#define MOUSE_WALL_LEFT 0x04
+
+typedef struct {
+    void *ctx; // Backend state, passed back to every hook
+
+    // Maze size reported by the environment
+    int (*maze_width)(void *ctx);
+    int (*maze_height)(void *ctx);
+
+    // Wall sensors, relative to the mouse's heading
+    bool (*wall_front)(void *ctx);
+    bool (*wall_right)(void *ctx);
+    bool (*wall_left)(void *ctx);
+
+    // Optional: all three sensors in one query, MOUSE_WALL_* bits. Used instead of
+    // the three calls above, one round trip per cell instead of three
+    uint8_t (*read_walls)(void *ctx);
+
+    // Motion. move_forward returns false if the mouse hit a wall and did not move
+    bool (*move_forward)(void *ctx);
+    void (*turn_right)(void *ctx);
+    void (*turn_left)(void *ctx);
+
+    // Optional: a straight of several cells as one motion (one mms command, one
+    // trapezoidal profile on hardware). Returns false if a wall cut it short
+    bool (*move_forward_n)(void *ctx, int cells);
+
+    // Optional: a one-cell move that does not block. start_forward begins it and
+    // returns at once, finish_forward waits for the end and reports like
+    // move_forward. Both or neither; with them the solver plans its next
+    // search step while the mouse is still travelling
+    void (*start_forward)(void *ctx);
+    bool (*finish_forward)(void *ctx);
+
+    // Optional, with start_forward / finish_forward: the walls of the cell being
+    // driven into, pushed by the backend as soon as the side sensors have seen
+    // them after the mouse entered it (early wall detection). Returns false while
+    // they are not in yet. The solver polls it during and right after the move,
+    // updates the map as soon as it answers and then skips sensing at the centre
+    bool (*walls_ahead)(void *ctx, uint8_t *walls);
+
+    // Optional: 45 degree primitives for diagonal speed runs, all four or none.
+    // move_half drives half a cell along the heading (cell centre to edge midpoint
+    // or back), move_diagonal `segments` half-diagonals from one cell edge midpoint
+    // to the next. Both return false if a wall stopped the mouse
+    bool (*move_half)(void *ctx);
+    void (*turn_right_45)(void *ctx);
+    void (*turn_left_45)(void *ctx);
+    bool (*move_diagonal)(void *ctx, int segments);
+
+    // Optional: the goal cells, asked for every cell when the maze is set up.
+    // Any set of cells; without the hook the goal is the centre 2x2 like mms
+    bool (*is_goal)(void *ctx, int x, int y);
+
+    // Optional: environment resets (mms "Reset" button)
+    bool (*was_reset)(void *ctx);
+    void (*ack_reset)(void *ctx);
+
+    // Optional: display. Targets without a screen leave all of these NULL, any
+    // one of them may be left out on its own
+    void (*set_wall)(void *ctx, int x, int y, char direction);
+    void (*set_color)(void *ctx, int x, int y, char color);
+    void (*set_text)(void *ctx, int x, int y, const char *text);
+    void (*clear_display)(void *ctx);
+
+    // Optional: keeps the learned map across resets and power cycles (flash on
+    // the mouse, a file on the host). load_map returns the image size, 0 if none
+    bool (*save_map)(void *ctx, const uint8_t *image, int size);
+    int (*load_map)(void *ctx, uint8_t *image, int capacity);
+
+    // Optional: brackets every flood fill so host backends can time it
+    void (*flood_fill_begin)(void *ctx);
+    void (*flood_fill_end)(void *ctx);
+} MouseIO;
+
+// Backend constructors
+const MouseIO *api_io(void);   // Whatever api.h is linked against (mms or headless), see io_api.c
+const MouseIO *stm32_io(void); // Board support hooks, see io_stm32.c
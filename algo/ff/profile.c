@@ -0,0 +1,157 @@
+// profile.c
+// Probe tables and clocks behind profile.h. Compiles to nothing unless
+// SOLVER_PROFILE is defined.
+
+#define _POSIX_C_SOURCE 200809L
+#include "profile.h"
+
+#ifdef SOLVER_PROFILE
+
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t calls;
+    uint64_t total;
+    ProfTick max;
+} ProfCounter;
+
+static ProfCounter prof_table[PROF_PHASE_COUNT][PROF_PROBE_COUNT];
+static int prof_phase = 0;
+
+// Solver time per step, backend round-trips taken out
+typedef struct {
+    uint32_t steps;
+    ProfTick max;
+    uint32_t buckets[PROF_HIST_BUCKETS];
+} ProfStepHistogram;
+
+static ProfStepHistogram prof_steps[PROF_PHASE_COUNT];
+static ProfTick prof_io_ticks;      // io_sense and io_motion time since reset
+static ProfTick prof_step_start, prof_step_io;
+
+static const char *const prof_probe_names[PROF_PROBE_COUNT] = {
+    "flood_fill", "shortest_path", "verify_path", "choose_direction",
+    "update_display", "io_sense", "io_motion", "cells_touched"};
+static const char *const prof_phase_names[PROF_PHASE_COUNT] = {"search", "return", "speed"};
+
+// --- Clock ---
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+
+// Cortex-M debug registers, addressed directly so no CMSIS header is needed
+#define PROF_DEMCR (*(volatile uint32_t *)0xE000EDFCu)
+#define PROF_DWT_CTRL (*(volatile uint32_t *)0xE0001000u)
+#define PROF_DWT_CYCCNT (*(volatile uint32_t *)0xE0001004u)
+#define PROF_UNIT "cycles"
+
+static void prof_clock_init(void) {
+    PROF_DEMCR |= 1u << 24; // TRCENA: enable the DWT block
+    PROF_DWT_CYCCNT = 0;
+    PROF_DWT_CTRL |= 1u;    // CYCCNTENA
+}
+
+ProfTick prof_now(void) {
+    return PROF_DWT_CYCCNT;
+}
+
+#else
+
+#include <time.h>
+#define PROF_UNIT "ns"
+
+static void prof_clock_init(void) {}
+
+ProfTick prof_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (ProfTick)now.tv_sec * 1000000000u + (ProfTick)now.tv_nsec;
+}
+
+#endif
+
+// --- Probes ---
+
+void prof_reset(void) {
+    memset(prof_table, 0, sizeof(prof_table));
+    memset(prof_steps, 0, sizeof(prof_steps));
+    prof_io_ticks = 0;
+    prof_phase = 0;
+    prof_clock_init();
+}
+
+void prof_set_phase(int phase) {
+    if (phase >= 0 && phase < PROF_PHASE_COUNT) prof_phase = phase;
+}
+
+void prof_add(ProfProbe probe, ProfTick start) {
+    ProfTick elapsed = prof_now() - start;
+    ProfCounter *counter = &prof_table[prof_phase][probe];
+    counter->calls++;
+    counter->total += elapsed;
+    if (elapsed > counter->max) counter->max = elapsed;
+    if (probe == PROF_IO_SENSE || probe == PROF_IO_MOTION) prof_io_ticks += elapsed;
+}
+
+void prof_count(ProfProbe probe, uint32_t amount) {
+    prof_table[prof_phase][probe].calls += amount;
+}
+
+// --- Step Times ---
+
+void prof_step_begin(void) {
+    prof_step_io = prof_io_ticks;
+    prof_step_start = prof_now();
+}
+
+// Counted in the phase the step started in
+void prof_step_end(void) {
+    ProfTick elapsed = prof_now() - prof_step_start - (prof_io_ticks - prof_step_io);
+    ProfStepHistogram *h = &prof_steps[prof_phase];
+    int bucket = 0;
+    while (bucket + 1 < PROF_HIST_BUCKETS && elapsed >> (bucket + 1)) bucket++;
+    h->steps++;
+    h->buckets[bucket]++;
+    if (elapsed > h->max) h->max = elapsed;
+}
+
+// Worst case and the occupied buckets of every phase, to stderr
+static void prof_report_steps(void) {
+    fprintf(stderr, "step time (" PROF_UNIT ", backend calls excluded)\n");
+    fprintf(stderr, "%-7s %10s %12s  %s\n", "phase", "steps", "max", "histogram [from, to) steps");
+    for (int phase = 0; phase < PROF_PHASE_COUNT; phase++) {
+        const ProfStepHistogram *h = &prof_steps[phase];
+        if (h->steps == 0) continue;
+        fprintf(stderr, "%-7s %10lu %12llu ", prof_phase_names[phase], (unsigned long)h->steps,
+                (unsigned long long)h->max);
+        for (int b = 0; b < PROF_HIST_BUCKETS; b++) {
+            if (h->buckets[b] == 0) continue;
+            fprintf(stderr, " [%llu,%llu) %lu", b ? 1ull << b : 0ull, 1ull << (b + 1), (unsigned long)h->buckets[b]);
+        }
+        fprintf(stderr, "\n");
+    }
+}
+
+// One line per phase and probe that fired, to stderr
+void prof_report(void) {
+    fprintf(stderr, "profile (" PROF_UNIT ", inclusive)\n");
+    fprintf(stderr, "%-7s %-17s %10s %14s %12s %12s\n", "phase", "probe", "calls", "total", "mean", "max");
+    for (int phase = 0; phase < PROF_PHASE_COUNT; phase++) {
+        for (int probe = 0; probe < PROF_PROBE_COUNT; probe++) {
+            const ProfCounter *c = &prof_table[phase][probe];
+            if (c->calls == 0) continue;
+            if (probe == PROF_CELLS) {
+                fprintf(stderr, "%-7s %-17s %10lu\n", prof_phase_names[phase], prof_probe_names[probe],
+                        (unsigned long)c->calls);
+                continue;
+            }
+            fprintf(stderr, "%-7s %-17s %10lu %14llu %12llu %12llu\n", prof_phase_names[phase],
+                    prof_probe_names[probe], (unsigned long)c->calls, (unsigned long long)c->total,
+                    (unsigned long long)(c->total / c->calls), (unsigned long long)c->max);
+        }
+    }
+    prof_report_steps();
+    fflush(stderr);
+}
+
+#endif
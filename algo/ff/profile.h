@@ -0,0 +1,73 @@
+#pragma once
+#include <stdint.h>
+
+// profile.h
+// Optional hot-path instrumentation for the solver core. Build with
+// -DSOLVER_PROFILE (and add profile.c) to time the probes below per run
+// phase; ticks are DWT cycles on Cortex-M and nanoseconds on the host.
+// Without SOLVER_PROFILE every macro expands to nothing, so release builds
+// carry no timing code at all.
+//
+// Times are inclusive: a flood fill run by the planner also counts towards
+// the shortest path probe. The tables are process-wide, profile one solver
+// at a time.
+//
+// Every solver_step is also timed without the io_sense / io_motion time in
+// it, the solver's own work between two backend calls, into a per-phase
+// histogram of power-of-two buckets. Its maximum is the observed worst case
+// to hold against the control loop's budget.
+
+typedef enum {
+    PROF_FLOOD_FILL,
+    PROF_SHORTEST_PATH,
+    PROF_VERIFY_PATH,
+    PROF_CHOOSE_DIRECTION,
+    PROF_UPDATE_DISPLAY,
+    PROF_IO_SENSE,   // wall_front / wall_right / wall_left round-trips
+    PROF_IO_MOTION,  // move_forward / move_forward_n / turn_* round-trips
+    PROF_CELLS,      // Counter: cells processed by flood fills
+    PROF_PROBE_COUNT
+} ProfProbe;
+
+#define PROF_PHASE_COUNT 3 // One per RunMode
+#define PROF_HIST_BUCKETS 32 // Bucket b counts steps of [2^b, 2^(b+1)) ticks, bucket 0 also 0 ticks
+
+#ifdef SOLVER_PROFILE
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+typedef uint32_t ProfTick; // DWT cycle counter, wraps but differences stay valid
+#else
+typedef uint64_t ProfTick;
+#endif
+
+void prof_reset(void);
+void prof_set_phase(int phase);
+ProfTick prof_now(void);
+void prof_add(ProfProbe probe, ProfTick start);
+void prof_count(ProfProbe probe, uint32_t amount);
+void prof_report(void);
+void prof_step_begin(void);
+void prof_step_end(void);
+
+// Times the statement that follows: PROF_SCOPE(PROF_FLOOD_FILL) flood_fill_goal(m);
+// The statement must not leave the scope early (return, break, goto).
+#define PROF_SCOPE(probe) \
+    for (ProfTick prof_start_ = prof_now(), prof_once_ = 1; prof_once_; prof_once_ = 0, prof_add(probe, prof_start_))
+#define PROF_COUNT(probe, amount) prof_count(probe, amount)
+#define PROF_PHASE(phase) prof_set_phase(phase)
+#define PROF_RESET() prof_reset()
+#define PROF_REPORT() prof_report()
+#define PROF_STEP_BEGIN() prof_step_begin()
+#define PROF_STEP_END() prof_step_end()
+
+#else
+
+#define PROF_SCOPE(probe)
+#define PROF_COUNT(probe, amount) ((void)0)
+#define PROF_PHASE(phase) ((void)0)
+#define PROF_RESET() ((void)0)
+#define PROF_REPORT() ((void)0)
+#define PROF_STEP_BEGIN() ((void)0)
+#define PROF_STEP_END() ((void)0)
+
+#endif
@@ -0,0 +1,439 @@
+#include "record.h"
+#include <stddef.h>
+#include <string.h>
+
+const char *const record_call_names[RECORD_CALL_COUNT] = {
+    "end",          "maze_width",    "maze_height",    "wall_front",    "wall_right",     "wall_left",
+    "move_forward", "turn_right",    "turn_left",      "move_forward_n", "start_forward", "finish_forward",
+    "move_half",    "turn_right_45", "turn_left_45",   "move_diagonal", "is_goal",       "was_reset",
+    "ack_reset",    "save_map",      "load_map",       "read_walls",    "walls_ahead"};
+
+// Calls followed by one byte: the argument the solver passed or the answer
+static bool has_arg(RecordCall call) {
+    return call == RECORD_MAZE_WIDTH || call == RECORD_MAZE_HEIGHT || call == RECORD_MOVE_FORWARD_N ||
+           call == RECORD_MOVE_DIAGONAL || call == RECORD_READ_WALLS || call == RECORD_WALLS_AHEAD;
+}
+
+// Bytes of the entry at e, 0 if fewer than that are available
+int record_entry_size(const uint8_t *e, uint32_t available) {
+    int size = 1;
+    RecordCall call = (RecordCall)(e[0] & RECORD_CALL_MASK);
+    if (has_arg(call)) size = 2;
+    if (call == RECORD_LOAD_MAP) size = available >= 3 ? 3 + (e[1] | e[2] << 8) : 3;
+    return (uint32_t)size <= available ? size : 0;
+}
+
+// --- Recording ---
+
+// Whole entries only: once one does not fit the log stops there, so a replay
+// of it runs up to the gap and then reports running past its end
+static void append(Recorder *r, const uint8_t *entry, int size, const uint8_t *tail, int tail_size) {
+    if (r->overflowed || r->length + size + tail_size > RECORD_CAPACITY) {
+        r->overflowed = true;
+        return;
+    }
+    memcpy(r->bytes + r->length, entry, (size_t)size);
+    if (tail_size > 0) memcpy(r->bytes + r->length + size, tail, (size_t)tail_size);
+    r->length += size + tail_size;
+    r->total += size + tail_size;
+}
+
+static void log_call(Recorder *r, RecordCall call, bool reply) {
+    uint8_t e = (uint8_t)(call | (reply ? RECORD_REPLY : 0));
+    append(r, &e, 1, NULL, 0);
+}
+
+static void log_arg(Recorder *r, RecordCall call, bool reply, int arg) {
+    uint8_t e[2] = {(uint8_t)(call | (reply ? RECORD_REPLY : 0)), (uint8_t)arg};
+    append(r, e, 2, NULL, 0);
+}
+
+static int rec_maze_width(void *ctx) {
+    Recorder *r = ctx;
+    int width = r->inner->maze_width(r->inner->ctx);
+    log_arg(r, RECORD_MAZE_WIDTH, false, width);
+    return width;
+}
+
+static int rec_maze_height(void *ctx) {
+    Recorder *r = ctx;
+    int height = r->inner->maze_height(r->inner->ctx);
+    log_arg(r, RECORD_MAZE_HEIGHT, false, height);
+    return height;
+}
+
+static bool rec_wall_front(void *ctx) {
+    Recorder *r = ctx;
+    bool wall = r->inner->wall_front(r->inner->ctx);
+    log_call(r, RECORD_WALL_FRONT, wall);
+    return wall;
+}
+
+static bool rec_wall_right(void *ctx) {
+    Recorder *r = ctx;
+    bool wall = r->inner->wall_right(r->inner->ctx);
+    log_call(r, RECORD_WALL_RIGHT, wall);
+    return wall;
+}
+
+static bool rec_wall_left(void *ctx) {
+    Recorder *r = ctx;
+    bool wall = r->inner->wall_left(r->inner->ctx);
+    log_call(r, RECORD_WALL_LEFT, wall);
+    return wall;
+}
+
+static uint8_t rec_read_walls(void *ctx) {
+    Recorder *r = ctx;
+    uint8_t walls = r->inner->read_walls(r->inner->ctx);
+    log_arg(r, RECORD_READ_WALLS, false, walls);
+    return walls;
+}
+
+static bool rec_move_forward(void *ctx) {
+    Recorder *r = ctx;
+    bool moved = r->inner->move_forward(r->inner->ctx);
+    log_call(r, RECORD_MOVE_FORWARD, moved);
+    return moved;
+}
+
+static void rec_turn_right(void *ctx) {
+    Recorder *r = ctx;
+    r->inner->turn_right(r->inner->ctx);
+    log_call(r, RECORD_TURN_RIGHT, false);
+}
+
+static void rec_turn_left(void *ctx) {
+    Recorder *r = ctx;
+    r->inner->turn_left(r->inner->ctx);
+    log_call(r, RECORD_TURN_LEFT, false);
+}
+
+static bool rec_move_forward_n(void *ctx, int cells) {
+    Recorder *r = ctx;
+    bool moved = r->inner->move_forward_n(r->inner->ctx, cells);
+    log_arg(r, RECORD_MOVE_FORWARD_N, moved, cells);
+    return moved;
+}
+
+static void rec_start_forward(void *ctx) {
+    Recorder *r = ctx;
+    r->inner->start_forward(r->inner->ctx);
+    log_call(r, RECORD_START_FORWARD, false);
+}
+
+static bool rec_finish_forward(void *ctx) {
+    Recorder *r = ctx;
+    bool moved = r->inner->finish_forward(r->inner->ctx);
+    log_call(r, RECORD_FINISH_FORWARD, moved);
+    return moved;
+}
+
+static bool rec_walls_ahead(void *ctx, uint8_t *walls) {
+    Recorder *r = ctx;
+    bool ready = r->inner->walls_ahead(r->inner->ctx, walls);
+    log_arg(r, RECORD_WALLS_AHEAD, ready, ready ? *walls : 0);
+    return ready;
+}
+
+static bool rec_move_half(void *ctx) {
+    Recorder *r = ctx;
+    bool moved = r->inner->move_half(r->inner->ctx);
+    log_call(r, RECORD_MOVE_HALF, moved);
+    return moved;
+}
+
+static void rec_turn_right_45(void *ctx) {
+    Recorder *r = ctx;
+    r->inner->turn_right_45(r->inner->ctx);
+    log_call(r, RECORD_TURN_RIGHT_45, false);
+}
+
+static void rec_turn_left_45(void *ctx) {
+    Recorder *r = ctx;
+    r->inner->turn_left_45(r->inner->ctx);
+    log_call(r, RECORD_TURN_LEFT_45, false);
+}
+
+static bool rec_move_diagonal(void *ctx, int segments) {
+    Recorder *r = ctx;
+    bool moved = r->inner->move_diagonal(r->inner->ctx, segments);
+    log_arg(r, RECORD_MOVE_DIAGONAL, moved, segments);
+    return moved;
+}
+
+// The solver asks for every cell in a fixed order, so the cell is not logged
+static bool rec_is_goal(void *ctx, int x, int y) {
+    Recorder *r = ctx;
+    bool goal = r->inner->is_goal(r->inner->ctx, x, y);
+    log_call(r, RECORD_IS_GOAL, goal);
+    return goal;
+}
+
+static bool rec_was_reset(void *ctx) {
+    Recorder *r = ctx;
+    bool reset = r->inner->was_reset(r->inner->ctx);
+    log_call(r, RECORD_WAS_RESET, reset);
+    return reset;
+}
+
+static void rec_ack_reset(void *ctx) {
+    Recorder *r = ctx;
+    r->inner->ack_reset(r->inner->ctx);
+    log_call(r, RECORD_ACK_RESET, false);
+}
+
+// The image is the solver's own, only whether the backend took it is logged
+static bool rec_save_map(void *ctx, const uint8_t *image, int size) {
+    Recorder *r = ctx;
+    bool saved = r->inner->save_map(r->inner->ctx, image, size);
+    log_call(r, RECORD_SAVE_MAP, saved);
+    return saved;
+}
+
+static int rec_load_map(void *ctx, uint8_t *image, int capacity) {
+    Recorder *r = ctx;
+    int size = r->inner->load_map(r->inner->ctx, image, capacity);
+    int logged = size > 0 ? size : 0;
+    uint8_t e[3] = {RECORD_LOAD_MAP, (uint8_t)logged, (uint8_t)(logged >> 8)};
+    append(r, e, 3, image, logged);
+    return size;
+}
+
+// Not logged, forwarded as they are
+static void rec_set_wall(void *ctx, int x, int y, char direction) {
+    Recorder *r = ctx;
+    r->inner->set_wall(r->inner->ctx, x, y, direction);
+}
+
+static void rec_set_color(void *ctx, int x, int y, char color) {
+    Recorder *r = ctx;
+    r->inner->set_color(r->inner->ctx, x, y, color);
+}
+
+static void rec_set_text(void *ctx, int x, int y, const char *text) {
+    Recorder *r = ctx;
+    r->inner->set_text(r->inner->ctx, x, y, text);
+}
+
+static void rec_clear_display(void *ctx) {
+    Recorder *r = ctx;
+    r->inner->clear_display(r->inner->ctx);
+}
+
+static void rec_flood_fill_begin(void *ctx) {
+    Recorder *r = ctx;
+    r->inner->flood_fill_begin(r->inner->ctx);
+}
+
+static void rec_flood_fill_end(void *ctx) {
+    Recorder *r = ctx;
+    r->inner->flood_fill_end(r->inner->ctx);
+}
+
+static uint16_t hooks_of(const MouseIO *io) {
+    uint16_t hooks = 0;
+    if (io->move_forward_n) hooks |= RECORD_HAS_MOVE_N;
+    if (io->start_forward && io->finish_forward) hooks |= RECORD_HAS_SPLIT_MOVE;
+    if (io->move_half && io->turn_right_45 && io->turn_left_45 && io->move_diagonal) hooks |= RECORD_HAS_DIAGONALS;
+    if (io->is_goal) hooks |= RECORD_HAS_GOAL;
+    if (io->was_reset) hooks |= RECORD_HAS_RESET;
+    if (io->ack_reset) hooks |= RECORD_HAS_ACK_RESET;
+    if (io->save_map) hooks |= RECORD_HAS_SAVE_MAP;
+    if (io->load_map) hooks |= RECORD_HAS_LOAD_MAP;
+    if (io->read_walls) hooks |= RECORD_HAS_READ_WALLS;
+    if (io->walls_ahead) hooks |= RECORD_HAS_WALLS_AHEAD;
+    return hooks;
+}
+
+const MouseIO *record_start(Recorder *r, const MouseIO *inner) {
+    memset(r, 0, sizeof(*r));
+    r->inner = inner;
+    r->hooks = hooks_of(inner);
+
+    MouseIO *io = &r->io;
+    io->ctx = r;
+    io->maze_width = rec_maze_width;
+    io->maze_height = rec_maze_height;
+    io->wall_front = rec_wall_front;
+    io->wall_right = rec_wall_right;
+    io->wall_left = rec_wall_left;
+    io->move_forward = rec_move_forward;
+    io->turn_right = rec_turn_right;
+    io->turn_left = rec_turn_left;
+    if (r->hooks & RECORD_HAS_MOVE_N) io->move_forward_n = rec_move_forward_n;
+    if (r->hooks & RECORD_HAS_SPLIT_MOVE) {
+        io->start_forward = rec_start_forward;
+        io->finish_forward = rec_finish_forward;
+    }
+    if (r->hooks & RECORD_HAS_DIAGONALS) {
+        io->move_half = rec_move_half;
+        io->turn_right_45 = rec_turn_right_45;
+        io->turn_left_45 = rec_turn_left_45;
+        io->move_diagonal = rec_move_diagonal;
+    }
+    if (r->hooks & RECORD_HAS_GOAL) io->is_goal = rec_is_goal;
+    if (r->hooks & RECORD_HAS_RESET) io->was_reset = rec_was_reset;
+    if (r->hooks & RECORD_HAS_ACK_RESET) io->ack_reset = rec_ack_reset;
+    if (r->hooks & RECORD_HAS_SAVE_MAP) io->save_map = rec_save_map;
+    if (r->hooks & RECORD_HAS_LOAD_MAP) io->load_map = rec_load_map;
+    if (r->hooks & RECORD_HAS_READ_WALLS) io->read_walls = rec_read_walls;
+    if (r->hooks & RECORD_HAS_WALLS_AHEAD) io->walls_ahead = rec_walls_ahead;
+    if (inner->set_wall) io->set_wall = rec_set_wall;
+    if (inner->set_color) io->set_color = rec_set_color;
+    if (inner->set_text) io->set_text = rec_set_text;
+    if (inner->clear_display) io->clear_display = rec_clear_display;
+    if (inner->flood_fill_begin) io->flood_fill_begin = rec_flood_fill_begin;
+    if (inner->flood_fill_end) io->flood_fill_end = rec_flood_fill_end;
+    return io;
+}
+
+// Entries are only ever taken whole, the buffer keeps whatever part of one did not fit in out
+int record_read(Recorder *r, uint8_t *out, int max) {
+    int count = 0;
+    while ((uint32_t)count < r->length) {
+        int size = record_entry_size(r->bytes + count, r->length - count);
+        if (size == 0 || count + size > max) break;
+        count += size;
+    }
+    memcpy(out, r->bytes, (size_t)count);
+    memmove(r->bytes, r->bytes + count, r->length - count);
+    r->length -= count;
+    return count;
+}
+
+// --- Replay ---
+
+static void diverge(Replay *r, RecordCall expected, int expected_arg, RecordCall actual, int actual_arg) {
+    r->diverged = true;
+    r->diverged_at = r->pos;
+    r->expected = expected;
+    r->expected_arg = expected_arg;
+    r->actual = actual;
+    r->actual_arg = actual_arg;
+}
+
+// Consumes the next entry if it is call (with arg, unless arg < 0) and returns
+// it, NULL once the run diverged here or earlier
+static const uint8_t *take(Replay *r, RecordCall call, int arg) {
+    if (r->diverged) return NULL;
+    if (r->pos >= r->length) {
+        diverge(r, RECORD_END, -1, call, arg);
+        return NULL;
+    }
+
+    const uint8_t *e = r->bytes + r->pos;
+    int size = record_entry_size(e, r->length - r->pos);
+    RecordCall logged = (RecordCall)(e[0] & RECORD_CALL_MASK);
+    if (size == 0) {
+        diverge(r, RECORD_END, -1, call, arg); // Cut off mid entry
+        return NULL;
+    }
+    int logged_arg = has_arg(logged) ? e[1] : -1;
+    if (logged != call || (arg >= 0 && logged_arg != (arg & 0xFF))) {
+        diverge(r, logged, logged_arg, call, arg);
+        return NULL;
+    }
+    r->pos += size;
+    r->calls++;
+    return e;
+}
+
+static bool replied(Replay *r, RecordCall call, int arg, bool otherwise) {
+    const uint8_t *e = take(r, call, arg);
+    return e ? (e[0] & RECORD_REPLY) != 0 : otherwise;
+}
+
+static int replay_maze_width(void *ctx) {
+    const uint8_t *e = take(ctx, RECORD_MAZE_WIDTH, -1);
+    return e ? e[1] : 0;
+}
+
+static int replay_maze_height(void *ctx) {
+    const uint8_t *e = take(ctx, RECORD_MAZE_HEIGHT, -1);
+    return e ? e[1] : 0;
+}
+
+// Past a divergence every sensor sees a wall and every move fails
+static bool replay_wall_front(void *ctx) { return replied(ctx, RECORD_WALL_FRONT, -1, true); }
+static bool replay_wall_right(void *ctx) { return replied(ctx, RECORD_WALL_RIGHT, -1, true); }
+static bool replay_wall_left(void *ctx) { return replied(ctx, RECORD_WALL_LEFT, -1, true); }
+static bool replay_move_forward(void *ctx) { return replied(ctx, RECORD_MOVE_FORWARD, -1, false); }
+static void replay_turn_right(void *ctx) { take(ctx, RECORD_TURN_RIGHT, -1); }
+static void replay_turn_left(void *ctx) { take(ctx, RECORD_TURN_LEFT, -1); }
+static bool replay_move_forward_n(void *ctx, int cells) { return replied(ctx, RECORD_MOVE_FORWARD_N, cells, false); }
+static void replay_start_forward(void *ctx) { take(ctx, RECORD_START_FORWARD, -1); }
+static bool replay_finish_forward(void *ctx) { return replied(ctx, RECORD_FINISH_FORWARD, -1, false); }
+static bool replay_move_half(void *ctx) { return replied(ctx, RECORD_MOVE_HALF, -1, false); }
+static void replay_turn_right_45(void *ctx) { take(ctx, RECORD_TURN_RIGHT_45, -1); }
+static void replay_turn_left_45(void *ctx) { take(ctx, RECORD_TURN_LEFT_45, -1); }
+static bool replay_move_diagonal(void *ctx, int segments) {
+    return replied(ctx, RECORD_MOVE_DIAGONAL, segments, false);
+}
+static uint8_t replay_read_walls(void *ctx) {
+    const uint8_t *e = take(ctx, RECORD_READ_WALLS, -1);
+    return e ? e[1] : MOUSE_WALL_FRONT | MOUSE_WALL_RIGHT | MOUSE_WALL_LEFT;
+}
+
+static bool replay_walls_ahead(void *ctx, uint8_t *walls) {
+    const uint8_t *e = take(ctx, RECORD_WALLS_AHEAD, -1);
+    if (e == NULL || !(e[0] & RECORD_REPLY)) return false;
+    *walls = e[1];
+    return true;
+}
+
+static bool replay_is_goal(void *ctx, int x, int y) { return replied(ctx, RECORD_IS_GOAL, -1, false); }
+static bool replay_was_reset(void *ctx) { return replied(ctx, RECORD_WAS_RESET, -1, false); }
+static void replay_ack_reset(void *ctx) { take(ctx, RECORD_ACK_RESET, -1); }
+static bool replay_save_map(void *ctx, const uint8_t *image, int size) {
+    return replied(ctx, RECORD_SAVE_MAP, -1, false);
+}
+
+static int replay_load_map(void *ctx, uint8_t *image, int capacity) {
+    const uint8_t *e = take(ctx, RECORD_LOAD_MAP, -1);
+    if (e == NULL) return 0;
+    int size = e[1] | e[2] << 8;
+    if (size > capacity) size = capacity;
+    memcpy(image, e + 3, (size_t)size);
+    return size;
+}
+
+const MouseIO *replay_start(Replay *r, uint16_t hooks, const uint8_t *bytes, uint32_t length) {
+    memset(r, 0, sizeof(*r));
+    r->bytes = bytes;
+    r->length = length;
+
+    MouseIO *io = &r->io;
+    io->ctx = r;
+    io->maze_width = replay_maze_width;
+    io->maze_height = replay_maze_height;
+    io->wall_front = replay_wall_front;
+    io->wall_right = replay_wall_right;
+    io->wall_left = replay_wall_left;
+    io->move_forward = replay_move_forward;
+    io->turn_right = replay_turn_right;
+    io->turn_left = replay_turn_left;
+    if (hooks & RECORD_HAS_MOVE_N) io->move_forward_n = replay_move_forward_n;
+    if (hooks & RECORD_HAS_SPLIT_MOVE) {
+        io->start_forward = replay_start_forward;
+        io->finish_forward = replay_finish_forward;
+    }
+    if (hooks & RECORD_HAS_DIAGONALS) {
+        io->move_half = replay_move_half;
+        io->turn_right_45 = replay_turn_right_45;
+        io->turn_left_45 = replay_turn_left_45;
+        io->move_diagonal = replay_move_diagonal;
+    }
+    if (hooks & RECORD_HAS_GOAL) io->is_goal = replay_is_goal;
+    if (hooks & RECORD_HAS_RESET) io->was_reset = replay_was_reset;
+    if (hooks & RECORD_HAS_ACK_RESET) io->ack_reset = replay_ack_reset;
+    if (hooks & RECORD_HAS_SAVE_MAP) io->save_map = replay_save_map;
+    if (hooks & RECORD_HAS_LOAD_MAP) io->load_map = replay_load_map;
+    if (hooks & RECORD_HAS_READ_WALLS) io->read_walls = replay_read_walls;
+    if (hooks & RECORD_HAS_WALLS_AHEAD) io->walls_ahead = replay_walls_ahead;
+    return io;
+}
+
+bool replay_finished(const Replay *r) {
+    return !r->diverged && r->pos == r->length;
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "mouse_io.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// record.h
+// Record / replay of a MouseIO conversation. A Recorder sits between the
+// solver and any backend (mms, the headless simulator, the STM32 board) and
+// logs every answer the backend gives: sensor readings, move results, the
+// maze size, goal cells, resets and saved maps. A Replay is a backend that
+// gives those answers back from the log, so the unchanged solver repeats a
+// field run offline at CPU speed and any change that makes it act differently
+// shows up as a divergence at the first call it does not repeat.
+//
+// A log entry is one byte, RecordCall in the low bits and the boolean answer in
+// RECORD_REPLY, followed by the call's one byte argument or answer where it has
+// one (maze size, move_forward_n cells, move_diagonal segments, wall readings) and, for
+// load_map, a little-endian uint16_t size and the image. Display and flood fill
+// hooks pass through untouched and are not logged.
+// tools/ffreplay.c runs a saved log.
+
+// Recorder buffer size in bytes. Drain it after every solver_step on the host;
+// on the mouse size it for a whole run
+#ifndef RECORD_CAPACITY
+#define RECORD_CAPACITY 4096
+#endif
+
+typedef enum {
+    RECORD_END = 0, // Not logged: what a Replay reports for calls past the end of the log
+    RECORD_MAZE_WIDTH,
+    RECORD_MAZE_HEIGHT,
+    RECORD_WALL_FRONT,
+    RECORD_WALL_RIGHT,
+    RECORD_WALL_LEFT,
+    RECORD_MOVE_FORWARD,
+    RECORD_TURN_RIGHT,
+    RECORD_TURN_LEFT,
+    RECORD_MOVE_FORWARD_N,
+    RECORD_START_FORWARD,
+    RECORD_FINISH_FORWARD,
+    RECORD_MOVE_HALF,
+    RECORD_TURN_RIGHT_45,
+    RECORD_TURN_LEFT_45,
+    RECORD_MOVE_DIAGONAL,
+    RECORD_IS_GOAL,
+    RECORD_WAS_RESET,
+    RECORD_ACK_RESET,
+    RECORD_SAVE_MAP,
+    RECORD_LOAD_MAP,
+    RECORD_READ_WALLS,   // Followed by the MOUSE_WALL_* answer
+    RECORD_WALLS_AHEAD,  // Reply = ready, followed by the walls (0 if not ready)
+    RECORD_CALL_COUNT
+} RecordCall;
+
+#define RECORD_CALL_MASK 0x1F
+#define RECORD_REPLY 0x80 // Boolean answer of the call
+
+// Optional MouseIO hooks the recorded backend had, a Replay offers the same ones
+#define RECORD_HAS_MOVE_N 0x01
+#define RECORD_HAS_SPLIT_MOVE 0x02 // start_forward / finish_forward
+#define RECORD_HAS_DIAGONALS 0x04  // All four 45 degree hooks
+#define RECORD_HAS_GOAL 0x08
+#define RECORD_HAS_RESET 0x10 // was_reset
+#define RECORD_HAS_ACK_RESET 0x20
+#define RECORD_HAS_SAVE_MAP 0x40
+#define RECORD_HAS_LOAD_MAP 0x80
+#define RECORD_HAS_READ_WALLS 0x100
+#define RECORD_HAS_WALLS_AHEAD 0x200
+
+// Saved logs: this header, then the entries in order
+#define RECORD_FILE_MAGIC "FFIO"
+#define RECORD_FILE_VERSION 1
+
+typedef struct {
+    char magic[4];    // RECORD_FILE_MAGIC
+    uint16_t version; // RECORD_FILE_VERSION
+    uint16_t hooks;   // RECORD_HAS_* bits
+} RecordFileHeader;
+
+typedef struct {
+    MouseIO io;           // Hand this to the solver
+    const MouseIO *inner; // The backend being recorded
+    uint16_t hooks;       // RECORD_HAS_* bits of inner
+    uint8_t bytes[RECORD_CAPACITY]; // Entries not drained yet
+    uint32_t length;
+    uint32_t total;   // Bytes logged since record_start
+    bool overflowed;  // An entry did not fit, nothing after it was logged
+} Recorder;
+
+typedef struct {
+    MouseIO io; // Hand this to the solver
+    const uint8_t *bytes;
+    uint32_t length;
+    uint32_t pos;  // Next entry
+    long calls;    // Entries replayed
+    // Set at the first call the log does not match, every answer after it is a
+    // wall ahead and a failed move so the solver winds down on its own
+    bool diverged;
+    uint32_t diverged_at; // Offset of the entry the solver did not repeat
+    RecordCall expected;  // The logged call there, RECORD_END past the end
+    RecordCall actual;    // What the solver asked for instead
+    int expected_arg, actual_arg;
+} Replay;
+
+// Wraps inner with the same optional hooks and starts an empty log
+const MouseIO *record_start(Recorder *r, const MouseIO *inner);
+int record_read(Recorder *r, uint8_t *out, int max); // Oldest first, returns the count copied
+int record_entry_size(const uint8_t *entry, uint32_t available); // 0 if the entry is cut off
+
+// Answers from a log of length bytes, offering the optional hooks in hooks.
+// bytes must stay valid while the solver runs
+const MouseIO *replay_start(Replay *r, uint16_t hooks, const uint8_t *bytes, uint32_t length);
+bool replay_finished(const Replay *r); // Every entry replayed and nothing diverged
+
+extern const char *const record_call_names[RECORD_CALL_COUNT];
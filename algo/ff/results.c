@@ -0,0 +1,207 @@
+#define _POSIX_C_SOURCE 200809L
+#include "results.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define BLOCK_HEADER_SIZE 8
+
+static size_t columns_end(int column_count) {
+    return sizeof(ResultsHeader) + (size_t)column_count * sizeof(ResultsColumn);
+}
+
+static bool write_all(int fd, const void *data, size_t size) {
+    const char *p = data;
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n <= 0) return false;
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+// --- Appending ---
+
+// An existing store's column list, compared byte for byte
+static bool same_columns(int fd, const ResultsColumn *columns, int column_count) {
+    ResultsHeader header;
+    if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        memcmp(header.magic, RESULTS_MAGIC, 4) != 0 || header.version != RESULTS_VERSION ||
+        header.column_count != column_count) {
+        return false;
+    }
+    ResultsColumn stored[RESULTS_MAX_COLUMNS];
+    size_t size = (size_t)column_count * sizeof(ResultsColumn);
+    return pread(fd, stored, size, sizeof(header)) == (ssize_t)size && memcmp(stored, columns, size) == 0;
+}
+
+// A store whose writer died inside the header or column list: no block can
+// follow, so it is written again from scratch
+static bool torn_header(int fd, off_t size) {
+    ResultsHeader header = {{0}, RESULTS_VERSION, 0};
+    memcpy(header.magic, RESULTS_MAGIC, 4);
+    if ((size_t)size < sizeof(header)) {
+        // Only the magic and version are known, the column count may differ
+        char start[sizeof(header)];
+        size_t known = offsetof(ResultsHeader, column_count);
+        if ((size_t)size < known) known = (size_t)size;
+        return pread(fd, start, known, 0) == (ssize_t)known && memcmp(start, &header, known) == 0;
+    }
+    ResultsHeader stored;
+    return pread(fd, &stored, sizeof(stored), 0) == (ssize_t)sizeof(stored) &&
+           memcmp(stored.magic, RESULTS_MAGIC, 4) == 0 && stored.version == RESULTS_VERSION &&
+           stored.column_count <= RESULTS_MAX_COLUMNS && (size_t)size < columns_end(stored.column_count);
+}
+
+// End of the last complete block, where a cut off block starts
+static off_t complete_end(int fd, off_t size, int column_count) {
+    off_t end = (off_t)columns_end(column_count);
+    uint32_t rows;
+    while (end + BLOCK_HEADER_SIZE <= size && pread(fd, &rows, sizeof(rows), end) == (ssize_t)sizeof(rows)) {
+        off_t block = BLOCK_HEADER_SIZE + (off_t)rows * column_count * (off_t)sizeof(ResultsValue);
+        if (end + block > size) break;
+        end += block;
+    }
+    return end;
+}
+
+bool results_append(const char *path, const ResultsColumn *columns, int column_count, const ResultsValue *values,
+                    uint32_t rows) {
+    if (column_count <= 0 || column_count > RESULTS_MAX_COLUMNS) return false;
+    int fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+    // Held until close: the header check, the repair and the block write of
+    // one appender happen together
+    struct flock lock = {0};
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    struct stat st;
+    if (fcntl(fd, F_SETLKW, &lock) != 0 || fstat(fd, &st) != 0) {
+        perror(path);
+        close(fd);
+        return false;
+    }
+
+    bool ok = true;
+    off_t size = st.st_size;
+    if (size > 0 && torn_header(fd, size)) {
+        fprintf(stderr, "%s: header cut off, written again\n", path);
+        ok = ftruncate(fd, 0) == 0;
+        size = 0;
+    }
+    if (size == 0) {
+        ResultsHeader header = {{0}, RESULTS_VERSION, (uint16_t)column_count};
+        memcpy(header.magic, RESULTS_MAGIC, 4);
+        ok = ok && write_all(fd, &header, sizeof(header)) &&
+             write_all(fd, columns, (size_t)column_count * sizeof(ResultsColumn));
+    } else if (!same_columns(fd, columns, column_count)) {
+        fprintf(stderr, "%s: not a results file with these columns\n", path);
+        close(fd);
+        return false;
+    } else {
+        // Drop a block cut off by a crashed appender, or ours would land
+        // behind it where no reader finds it
+        off_t end = complete_end(fd, size, column_count);
+        if (end < size) {
+            fprintf(stderr, "%s: dropped %lld bytes of a cut off block\n", path, (long long)(size - end));
+            ok = ftruncate(fd, end) == 0;
+        }
+    }
+
+    // One write per block, so a crash leaves at most a cut off last block,
+    // which the next append drops. O_APPEND writes at the truncated end
+    size_t payload = (size_t)rows * column_count * sizeof(ResultsValue);
+    uint8_t *block = malloc(BLOCK_HEADER_SIZE + payload);
+    if (block == NULL) {
+        close(fd);
+        return false;
+    }
+    uint32_t block_header[2] = {rows, 0};
+    memcpy(block, block_header, BLOCK_HEADER_SIZE);
+    if (payload > 0) memcpy(block + BLOCK_HEADER_SIZE, values, payload);
+    ok = ok && write_all(fd, block, BLOCK_HEADER_SIZE + payload);
+    free(block);
+
+    if (close(fd) != 0) ok = false;
+    if (!ok) fprintf(stderr, "%s: write failed\n", path);
+    return ok;
+}
+
+// --- Reading ---
+
+bool results_open(ResultsFile *f, const char *path) {
+    memset(f, 0, sizeof(*f));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ResultsHeader)) {
+        fprintf(stderr, "%s: not a results file\n", path);
+        close(fd);
+        return false;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror(path);
+        return false;
+    }
+
+    const ResultsHeader *header = map;
+    if (memcmp(header->magic, RESULTS_MAGIC, 4) != 0 || header->version != RESULTS_VERSION ||
+        header->column_count > RESULTS_MAX_COLUMNS || (size_t)st.st_size < columns_end(header->column_count)) {
+        fprintf(stderr, "%s: not a version %d results file\n", path, RESULTS_VERSION);
+        munmap(map, (size_t)st.st_size);
+        return false;
+    }
+    f->columns = (const ResultsColumn *)(header + 1);
+    f->column_count = header->column_count;
+    f->map = map;
+    f->map_size = (size_t)st.st_size;
+    f->data = columns_end(header->column_count);
+
+    size_t offset = 0;
+    ResultsBlock block;
+    while (results_next_block(f, &offset, &block)) {
+        f->rows += block.rows;
+        f->blocks++;
+    }
+    return true;
+}
+
+void results_close(ResultsFile *f) {
+    if (f->map) munmap(f->map, f->map_size);
+    memset(f, 0, sizeof(*f));
+}
+
+bool results_next_block(const ResultsFile *f, size_t *offset, ResultsBlock *block) {
+    size_t start = f->data + *offset;
+    if (start + BLOCK_HEADER_SIZE > f->map_size) return false;
+    const uint8_t *base = (const uint8_t *)f->map + start;
+    uint32_t rows;
+    memcpy(&rows, base, sizeof(rows));
+    size_t size = BLOCK_HEADER_SIZE + (size_t)rows * f->column_count * sizeof(ResultsValue);
+    if (start + size > f->map_size) return false; // Cut off
+
+    block->values = (const ResultsValue *)(base + BLOCK_HEADER_SIZE);
+    block->rows = rows;
+    *offset += size;
+    return true;
+}
+
+int results_column(const ResultsFile *f, const char *name) {
+    for (int i = 0; i < f->column_count; i++) {
+        if (strncmp(f->columns[i].name, name, RESULTS_NAME_SIZE) == 0) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// results.h
+// Append-only columnar store for per-run metrics. Every append adds one
+// block of rows stored column by column, so a sweep that adds a million runs
+// writes one block per invocation and a reader that wants two columns only
+// touches their pages. Concurrent appends from several processes are
+// serialised with a lock on the file; a block cut off by a crash is ignored
+// by readers and dropped by the next append. tools/ffresults.c prints a store
+// as csv or json.
+//
+//   0   ResultsHeader: "FFRS", version, column count
+//   8   ResultsColumn per column
+//   ..  blocks: uint32_t rows, uint32_t reserved, then rows values of each
+//       column in turn, 8 bytes each (int64_t or double by column type)
+
+#define RESULTS_MAGIC "FFRS"
+#define RESULTS_VERSION 1
+#define RESULTS_MAX_COLUMNS 64
+#define RESULTS_NAME_SIZE 28
+
+typedef enum { RESULTS_INT, RESULTS_REAL } ResultsType;
+
+typedef struct {
+    char magic[4];         // RESULTS_MAGIC
+    uint16_t version;      // RESULTS_VERSION
+    uint16_t column_count;
+} ResultsHeader;
+
+typedef struct {
+    char name[RESULTS_NAME_SIZE]; // NUL terminated
+    uint32_t type;                // ResultsType
+} ResultsColumn;
+
+typedef union {
+    int64_t i; // RESULTS_INT columns
+    double r;  // RESULTS_REAL columns
+} ResultsValue;
+
+typedef struct {
+    const ResultsValue *values; // Column c of the block at values + c * rows
+    uint32_t rows;
+} ResultsBlock;
+
+typedef struct {
+    const ResultsColumn *columns; // Inside the mapping, read-only
+    int column_count;
+    long rows;   // Over all complete blocks
+    long blocks;
+    void *map;
+    size_t map_size;
+    size_t data; // Offset of the first block
+} ResultsFile;
+
+// --- Appending ---
+
+// Adds rows rows to the store at path, values column by column (column c of row
+// r at values[c * rows + r]). Creates the store with these columns if the file
+// is missing, empty or cut off inside its header; an existing store must have
+// exactly the same columns.
+// Returns false, with an error on stderr, if the file cannot be written or its
+// columns differ
+bool results_append(const char *path, const ResultsColumn *columns, int column_count, const ResultsValue *values,
+                    uint32_t rows);
+
+// --- Reading ---
+
+// Maps the store at path read-only. Returns false, with an error on stderr, if
+// it cannot be mapped or is not a version RESULTS_VERSION store
+bool results_open(ResultsFile *f, const char *path);
+void results_close(ResultsFile *f);
+
+// Block iteration: start with *offset = 0, false after the last complete block
+bool results_next_block(const ResultsFile *f, size_t *offset, ResultsBlock *block);
+int results_column(const ResultsFile *f, const char *name); // Index, -1 if there is no such column
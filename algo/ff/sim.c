@@ -0,0 +1,420 @@
+#define _POSIX_C_SOURCE 200809L
+#include "sim.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SIM_LINE_SIZE 256
+
+static const int sim_dx[4] = {0, 1, 0, -1};
+static const int sim_dy[4] = {1, 0, -1, 0};
+
+// --- Setup ---
+
+void sim_init(Sim *sim, int width, int height) {
+    memset(sim, 0, sizeof(*sim));
+    sim->width = width;
+    sim->height = height;
+    sim->max_steps = SIM_DEFAULT_MAX_STEPS;
+    sim->first_goal_moves = sim->first_return_moves = -1;
+    sim->first_goal_turns = sim->first_return_turns = -1;
+    sim->last_mark = 'S';
+}
+
+// Sets a wall on both cells that share it
+void sim_set_wall(Sim *sim, int x, int y, int heading) {
+    if (x < 0 || x >= sim->width || y < 0 || y >= sim->height) return;
+    sim->walls[x][y] |= (unsigned char)(1 << heading);
+    int nx = x + sim_dx[heading];
+    int ny = y + sim_dy[heading];
+    if (nx >= 0 && nx < sim->width && ny >= 0 && ny < sim->height) {
+        sim->walls[nx][ny] |= (unsigned char)(1 << ((heading + 2) % 4));
+    }
+}
+
+// .num: one "x y north east south west" line per cell
+static bool sim_load_num(Sim *sim, FILE *file) {
+    char line[SIM_LINE_SIZE];
+    while (fgets(line, sizeof(line), file)) {
+        int x, y, n, e, s, w;
+        if (sscanf(line, "%d %d %d %d %d %d", &x, &y, &n, &e, &s, &w) != 6) continue;
+        if (x < 0 || x >= SIM_MAX_SIZE || y < 0 || y >= SIM_MAX_SIZE) return false;
+        if (x + 1 > sim->width) sim->width = x + 1;
+        if (y + 1 > sim->height) sim->height = y + 1;
+        sim->walls[x][y] |= (unsigned char)((n ? SIM_NORTH : 0) | (e ? SIM_EAST : 0) |
+                                            (s ? SIM_SOUTH : 0) | (w ? SIM_WEST : 0));
+    }
+    return sim->width > 0 && sim->height > 0;
+}
+
+// .map: ascii drawing, top row first, 4 characters per cell ("o---", "|   ")
+static bool sim_load_map(Sim *sim, FILE *file) {
+    char lines[2 * SIM_MAX_SIZE + 1][SIM_LINE_SIZE];
+    int count = 0;
+    char line[SIM_LINE_SIZE];
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0') continue;
+        if (count == 2 * SIM_MAX_SIZE + 1) return false;
+        strcpy(lines[count++], line);
+    }
+    if (count < 3 || count % 2 == 0) return false;
+
+    sim->height = (count - 1) / 2;
+    sim->width = (int)(strlen(lines[0]) - 1) / 4;
+    if (sim->width <= 0 || sim->width > SIM_MAX_SIZE) return false;
+
+    for (int i = 0; i < count; i++) {
+        int length = (int)strlen(lines[i]);
+        if (i % 2 == 0) {
+            // Wall segments along the south side of row y (top edge when y == height)
+            int y = sim->height - i / 2;
+            for (int x = 0; x < sim->width; x++) {
+                for (int c = 4 * x + 1; c <= 4 * x + 3 && c < length; c++) {
+                    if (lines[i][c] == '-') {
+                        sim_set_wall(sim, x, y, 2);
+                        sim_set_wall(sim, x, y - 1, 0);
+                        break;
+                    }
+                }
+            }
+        } else {
+            // Wall segments along the west side of each cell in row y
+            int y = sim->height - 1 - (i - 1) / 2;
+            for (int x = 0; x <= sim->width && 4 * x < length; x++) {
+                if (lines[i][4 * x] == '|') {
+                    sim_set_wall(sim, x, y, 3);
+                    sim_set_wall(sim, x - 1, y, 1);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool sim_load_file(Sim *sim, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return false;
+
+    sim_init(sim, 0, 0);
+
+    // .num files start with a digit, .map files with the ascii drawing
+    int first = fgetc(file);
+    while (first != EOF && isspace(first)) first = fgetc(file);
+    ungetc(first, file);
+    bool ok = isdigit(first) ? sim_load_num(sim, file) : sim_load_map(sim, file);
+    fclose(file);
+    return ok;
+}
+
+// Replaces the goal with the cells and rectangles in spec. Returns false, keeping
+// the old goal, if spec is malformed, empty, leaves the maze or covers the start.
+bool sim_set_goal(Sim *sim, const char *spec) {
+    uint32_t rows[SIM_MAX_SIZE] = {0};
+    bool any = false;
+    const char *p = spec;
+    while (*p) {
+        int x1, y1, x2, y2, used = 0;
+        if (sscanf(p, " %d , %d - %d , %d %n", &x1, &y1, &x2, &y2, &used) != 4 || used == 0) {
+            used = 0;
+            if (sscanf(p, " %d , %d %n", &x1, &y1, &used) != 2 || used == 0) return false;
+            x2 = x1;
+            y2 = y1;
+        }
+        if (x1 > x2 || y1 > y2 || x1 < 0 || y1 < 0 || x2 >= sim->width || y2 >= sim->height) return false;
+        for (int y = y1; y <= y2; y++) {
+            for (int x = x1; x <= x2; x++) rows[y] |= 1u << x;
+        }
+        any = true;
+        p += used;
+        if (*p == ';') {
+            p++;
+        } else if (*p) {
+            return false;
+        }
+    }
+    if (!any || (rows[0] & 1u)) return false;
+    memcpy(sim->goal_rows, rows, sizeof(rows));
+    sim->has_goal = true;
+    return true;
+}
+
+// --- Phase Tracking ---
+
+// The goal set with sim_set_goal, else the mms goal: the centre 2x2 block
+// (a single cell for odd dimensions)
+bool sim_is_goal(const Sim *sim, int x, int y) {
+    if (sim->has_goal) {
+        return x >= 0 && x < sim->width && y >= 0 && y < sim->height && ((sim->goal_rows[y] >> x) & 1);
+    }
+    int x1 = (sim->width - 1) / 2, x2 = sim->width / 2;
+    int y1 = (sim->height - 1) / 2, y2 = sim->height / 2;
+    return x >= x1 && x <= x2 && y >= y1 && y <= y2;
+}
+
+// Records phase boundaries whenever the mouse arrives in the goal or at the start
+static void sim_track_phase(Sim *sim) {
+    if (sim_is_goal(sim, sim->x, sim->y) && sim->last_mark != 'G') {
+        sim->last_mark = 'G';
+        if (sim->first_goal_moves < 0) {
+            sim->first_goal_moves = sim->moves;
+            sim->first_goal_turns = sim->turns;
+        }
+    } else if (sim->x == 0 && sim->y == 0 && sim->last_mark != 'S') {
+        sim->last_mark = 'S';
+        if (sim->first_goal_moves >= 0 && sim->first_return_moves < 0) {
+            sim->first_return_moves = sim->moves;
+            sim->first_return_turns = sim->turns;
+        }
+        sim->last_start_moves = sim->moves;
+        sim->last_start_turns = sim->turns;
+    }
+}
+
+// Turns in place at the start, like the reorientation to north before the
+// speed run, still belong to the leg that ended there
+static void sim_track_turn(Sim *sim) {
+    if (sim->x == 0 && sim->y == 0 && sim->last_mark == 'S') sim->last_start_turns = sim->turns;
+}
+
+// --- Mouse Interface ---
+
+bool sim_wall(const Sim *sim, int relative_heading) {
+    int heading = (sim->heading + relative_heading) % 4;
+    return (sim->walls[sim->x][sim->y] >> heading) & 1;
+}
+
+// Walls of cell (x,y) as MOUSE_WALL_* bits for the mouse's heading
+static uint8_t relative_walls(const Sim *sim, int x, int y) {
+    unsigned char w = sim->walls[x][y];
+    int h = sim->heading;
+    return ((w >> h) & 1 ? MOUSE_WALL_FRONT : 0) | ((w >> ((h + 1) % 4)) & 1 ? MOUSE_WALL_RIGHT : 0) |
+           ((w >> ((h + 3) % 4)) & 1 ? MOUSE_WALL_LEFT : 0);
+}
+
+uint8_t sim_read_walls(const Sim *sim) {
+    return relative_walls(sim, sim->x, sim->y);
+}
+
+// What the sensors see on entering the cell ahead, read before the move into it.
+// Not counted as a step, an early reading costs the mouse no extra motion either
+bool sim_walls_ahead(const Sim *sim, uint8_t *walls) {
+    if (sim->at_edge || sim->diagonal != 0 || sim_wall(sim, 0)) return false;
+    *walls = relative_walls(sim, sim->x + sim_dx[sim->heading], sim->y + sim_dy[sim->heading]);
+    return true;
+}
+
+// Counts one step against max_steps, returns false once the limit is hit
+static bool sim_take_step(Sim *sim) {
+    if (sim->moves + sim->turns + sim->crashes >= sim->max_steps) {
+        sim->step_limit_hit = true;
+        return false;
+    }
+    return true;
+}
+
+bool sim_move_forward(Sim *sim) {
+    if (!sim_take_step(sim)) return false;
+    if (sim->at_edge || sim->diagonal != 0 || sim_wall(sim, 0)) {
+        sim->crashes++;
+        return false;
+    }
+    sim->moves++;
+    sim->x += sim_dx[sim->heading];
+    sim->y += sim_dy[sim->heading];
+    sim_track_phase(sim);
+    return true;
+}
+
+// A straight of several cells stops at the first wall, like mms
+int sim_move_forward_n(Sim *sim, int cells) {
+    int moved = 0;
+    while (moved < cells && sim_move_forward(sim)) moved++;
+    return moved;
+}
+
+void sim_turn(Sim *sim, int quarter_turns) {
+    if (!sim_take_step(sim)) return;
+    sim->turns++;
+    sim->heading = ((sim->heading + quarter_turns) % 4 + 4) % 4;
+    sim_track_turn(sim);
+}
+
+// Crosses the edge on `heading` of the current cell into the neighbour
+static bool sim_cross(Sim *sim, int heading) {
+    if ((sim->walls[sim->x][sim->y] >> heading) & 1) {
+        sim->crashes++;
+        return false;
+    }
+    sim->moves++;
+    sim->x += sim_dx[heading];
+    sim->y += sim_dy[heading];
+    sim->at_edge = true;
+    sim->edge_heading = heading;
+    sim_track_phase(sim);
+    return true;
+}
+
+// Centre to the edge ahead, or from the edge just crossed on to the centre
+bool sim_move_half(Sim *sim) {
+    if (!sim_take_step(sim)) return false;
+    if (sim->diagonal != 0 || (sim->at_edge && sim->heading != sim->edge_heading)) {
+        sim->crashes++;
+        return false;
+    }
+    if (sim->at_edge) {
+        sim->at_edge = false;
+        return true;
+    }
+    return sim_cross(sim, sim->heading);
+}
+
+// Each half-diagonal leaves the current cell through the side the mouse did not enter by
+bool sim_move_diagonal(Sim *sim, int segments) {
+    if (!sim_take_step(sim)) return false;
+    if (!sim->at_edge || sim->diagonal == 0) {
+        sim->crashes++;
+        return false;
+    }
+    int a = sim->heading, b = (sim->heading + sim->diagonal + 4) % 4;
+    for (int i = 0; i < segments; i++) {
+        int exit = sim->edge_heading == a ? b : sim->edge_heading == b ? a : -1;
+        if (exit < 0) {
+            sim->crashes++;
+            return false;
+        }
+        if (!sim_cross(sim, exit)) return false;
+    }
+    return true;
+}
+
+// Headings between two axes are kept as the axis plus a +1 / -1 offset
+void sim_turn_45(Sim *sim, int direction) {
+    if (!sim_take_step(sim)) return;
+    sim->turns++;
+    if (sim->diagonal == 0) {
+        sim->diagonal = direction;
+    } else {
+        if (sim->diagonal == direction) sim->heading = (sim->heading + direction + 4) % 4;
+        sim->diagonal = 0;
+    }
+    sim_track_turn(sim);
+}
+
+// --- MouseIO Binding ---
+
+static int sim_io_maze_width(void *ctx) { return ((Sim *)ctx)->width; }
+static int sim_io_maze_height(void *ctx) { return ((Sim *)ctx)->height; }
+static bool sim_io_wall_front(void *ctx) { return sim_wall(ctx, 0); }
+static bool sim_io_wall_right(void *ctx) { return sim_wall(ctx, 1); }
+static bool sim_io_wall_left(void *ctx) { return sim_wall(ctx, 3); }
+static uint8_t sim_io_read_walls(void *ctx) { return sim_read_walls(ctx); }
+static bool sim_io_walls_ahead(void *ctx, uint8_t *walls) { return sim_walls_ahead(ctx, walls); }
+static bool sim_io_move_forward(void *ctx) { return sim_move_forward(ctx); }
+static bool sim_io_move_forward_n(void *ctx, int cells) { return sim_move_forward_n(ctx, cells) == cells; }
+static void sim_io_turn_right(void *ctx) { sim_turn(ctx, 1); }
+static void sim_io_turn_left(void *ctx) { sim_turn(ctx, -1); }
+static bool sim_io_move_half(void *ctx) { return sim_move_half(ctx); }
+static bool sim_io_move_diagonal(void *ctx, int segments) { return sim_move_diagonal(ctx, segments); }
+static void sim_io_turn_right_45(void *ctx) { sim_turn_45(ctx, 1); }
+static void sim_io_turn_left_45(void *ctx) { sim_turn_45(ctx, -1); }
+// The simulator moves instantly, so the whole move happens when it is waited for
+static void sim_io_start_forward(void *ctx) {}
+static bool sim_io_finish_forward(void *ctx) { return sim_move_forward(ctx); }
+
+static bool sim_io_is_goal(void *ctx, int x, int y) { return sim_is_goal(ctx, x, y); }
+
+static void sim_io_flood_fill_begin(void *ctx) { sim_flood_fill_begin(ctx); }
+static void sim_io_flood_fill_end(void *ctx) { sim_flood_fill_end(ctx); }
+
+MouseIO sim_io(Sim *sim) {
+    MouseIO io = {0};
+    io.ctx = sim;
+    io.maze_width = sim_io_maze_width;
+    io.maze_height = sim_io_maze_height;
+    io.wall_front = sim_io_wall_front;
+    io.wall_right = sim_io_wall_right;
+    io.wall_left = sim_io_wall_left;
+    io.read_walls = sim_io_read_walls;
+    io.move_forward = sim_io_move_forward;
+    io.move_forward_n = sim_io_move_forward_n;
+    io.turn_right = sim_io_turn_right;
+    io.turn_left = sim_io_turn_left;
+    if (sim->diagonals) {
+        io.move_half = sim_io_move_half;
+        io.turn_right_45 = sim_io_turn_right_45;
+        io.turn_left_45 = sim_io_turn_left_45;
+        io.move_diagonal = sim_io_move_diagonal;
+    }
+    if (sim->pipeline) {
+        io.start_forward = sim_io_start_forward;
+        io.finish_forward = sim_io_finish_forward;
+        io.walls_ahead = sim_io_walls_ahead;
+    }
+    io.is_goal = sim_io_is_goal;
+    io.flood_fill_begin = sim_io_flood_fill_begin;
+    io.flood_fill_end = sim_io_flood_fill_end;
+    return io;
+}
+
+// --- Reporting ---
+
+// CPU time of the calling thread, so parallel simulators don't see each other
+double sim_cpu_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+// Nested brackets are counted once
+void sim_flood_fill_begin(Sim *sim) {
+    if (sim->flood_fill_depth++ == 0) sim->flood_fill_start = sim_cpu_seconds();
+}
+
+void sim_flood_fill_end(Sim *sim) {
+    if (--sim->flood_fill_depth == 0) {
+        sim->flood_fill_seconds += sim_cpu_seconds() - sim->flood_fill_start;
+    }
+}
+
+static long sim_span(long from, long to) { return from < 0 || to < 0 ? 0 : to - from; }
+
+SimStats sim_stats(const Sim *sim) {
+    SimStats stats = {0};
+    stats.reached_goal = sim_is_goal(sim, sim->x, sim->y);
+    // A speed run only exists if the mouse came back and ended the run in the goal
+    bool speed_run = stats.reached_goal && sim->first_return_moves >= 0 &&
+                     sim->last_start_moves >= sim->first_return_moves;
+
+    stats.search_cells = sim->first_goal_moves < 0 ? sim->moves : sim->first_goal_moves;
+    stats.search_turns = sim->first_goal_turns < 0 ? sim->turns : sim->first_goal_turns;
+    stats.return_cells = sim_span(sim->first_goal_moves, sim->first_return_moves);
+    stats.return_turns = sim_span(sim->first_goal_turns, sim->first_return_turns);
+    stats.explore_cells = speed_run ? sim->last_start_moves : sim->moves;
+    stats.speed_cells = speed_run ? sim->moves - sim->last_start_moves : 0;
+    stats.speed_turns = speed_run ? sim->turns - sim->last_start_turns : 0;
+    stats.moves = sim->moves;
+    stats.turns = sim->turns;
+    stats.crashes = sim->crashes;
+    stats.flood_fill_ms = sim->flood_fill_seconds * 1e3;
+    return stats;
+}
+
+// Writes the metrics as one line of key=value pairs (read by tools/ffbench.c)
+bool sim_write_stats(const Sim *sim, const char *path, double cpu_ms) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) return false;
+
+    SimStats st = sim_stats(sim);
+    fprintf(file,
+            "reached_goal=%d search_cells=%ld search_turns=%ld return_cells=%ld "
+            "return_turns=%ld explore_cells=%ld speed_cells=%ld speed_turns=%ld "
+            "moves=%ld turns=%ld crashes=%ld flood_fill_ms=%.3f cpu_ms=%.3f\n",
+            st.reached_goal, st.search_cells, st.search_turns, st.return_cells,
+            st.return_turns, st.explore_cells, st.speed_cells, st.speed_turns, st.moves,
+            st.turns, st.crashes, st.flood_fill_ms, cpu_ms);
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include "mouse_io.h"
+#include <stdbool.h>
+
+// sim.h
+// Headless in-process maze simulator.
+// Loads an mms maze file (.num or .map), answers sensor queries and moves
+// from it and renders nothing. Every Sim is independent, so many can run
+// side by side (one per solver instance or thread).
+//
+// The run is split into phases from the mouse position alone: the search run
+// ends on the first arrival in the goal, the return trip on the next arrival
+// at the start, and the speed run is the final start -> goal leg, from the
+// first move out of the start cell.
+
+#define SIM_MAX_SIZE 32
+#define SIM_DEFAULT_MAX_STEPS 100000
+
+// Wall bits per cell, indexed like the mouse heading (0 = north, clockwise)
+#define SIM_NORTH 1
+#define SIM_EAST 2
+#define SIM_SOUTH 4
+#define SIM_WEST 8
+
+typedef struct {
+    int width;
+    int height;
+    unsigned char walls[SIM_MAX_SIZE][SIM_MAX_SIZE]; // [x][y], SIM_* bits
+    bool has_goal;                      // goal_rows replaces the mms centre 2x2
+    uint32_t goal_rows[SIM_MAX_SIZE];   // Goal cells, bit x of row y
+
+    // Mouse pose, starting in (0,0) facing north like mms
+    int x;
+    int y;
+    int heading;
+    int diagonal;     // 0 along heading, +1 / -1 turned 45 degrees right / left of it
+    bool at_edge;     // On the edge midpoint where the mouse entered (x,y), not the centre
+    int edge_heading; // Direction the mouse crossed that edge in
+
+    long moves;
+    long turns;
+    long crashes;
+    long max_steps;         // Moves + turns + crashes before the run is aborted
+    bool step_limit_hit;    // Set once max_steps is exceeded, every move then fails
+
+    // Optional hooks for sim_io, off after sim_init like api_sim without
+    // SIM_DIAGONALS / SIM_PIPELINE
+    bool diagonals; // move_half, 45 degree turns and move_diagonal
+    bool pipeline;  // start_forward / finish_forward and walls_ahead
+
+    // Phase boundaries, as move/turn counts at the time of the event (-1 if never)
+    long first_goal_moves, first_goal_turns;     // End of the search run
+    long first_return_moves, first_return_turns; // Back at start after the first goal
+    long last_start_moves, last_start_turns;     // Last departure from start
+    char last_mark; // 'G' or 'S', last special cell the mouse stood in
+
+    // CPU time spent between flood_fill_begin / flood_fill_end
+    int flood_fill_depth;
+    double flood_fill_start;
+    double flood_fill_seconds;
+} Sim;
+
+// Per-run metrics derived from the phase boundaries
+typedef struct {
+    bool reached_goal;
+    long search_cells, search_turns;
+    long return_cells, return_turns;
+    long explore_cells; // Everything before the speed run
+    long speed_cells, speed_turns;
+    long moves, turns, crashes;
+    double flood_fill_ms;
+} SimStats;
+
+// --- Setup ---
+void sim_init(Sim *sim, int width, int height);
+bool sim_load_file(Sim *sim, const char *path);
+void sim_set_wall(Sim *sim, int x, int y, int heading);
+bool sim_set_goal(Sim *sim, const char *spec); // "x,y" cells, "x1,y1-x2,y2" rectangles, ';' separated, not (0,0)
+
+// --- Mouse Interface ---
+bool sim_wall(const Sim *sim, int relative_heading); // 0 front, 1 right, 3 left
+uint8_t sim_read_walls(const Sim *sim);              // All three, MOUSE_WALL_* bits
+bool sim_walls_ahead(const Sim *sim, uint8_t *walls); // The next cell's, false if a wall is in the way
+bool sim_move_forward(Sim *sim);
+int sim_move_forward_n(Sim *sim, int cells); // Returns the cells actually moved
+void sim_turn(Sim *sim, int quarter_turns); // +1 right, -1 left
+
+// 45 degree primitives for diagonal runs, see mouse_io.h. Every cell entered counts
+// as a move and every 45 degree turn as a turn
+bool sim_move_half(Sim *sim);
+bool sim_move_diagonal(Sim *sim, int segments);
+void sim_turn_45(Sim *sim, int direction); // +1 right, -1 left
+
+// Binds a MouseIO to this simulator (no display hooks), with the optional
+// motion hooks sim->diagonals and sim->pipeline ask for
+MouseIO sim_io(Sim *sim);
+
+// --- Reporting ---
+bool sim_is_goal(const Sim *sim, int x, int y);
+SimStats sim_stats(const Sim *sim);
+bool sim_write_stats(const Sim *sim, const char *path, double cpu_ms);
+double sim_cpu_seconds(void);
+void sim_flood_fill_begin(Sim *sim);
+void sim_flood_fill_end(Sim *sim);
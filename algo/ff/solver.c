@@ -0,0 +1,1831 @@
+#include "solver.h"
+#include "map_image.h"
+#include "profile.h"
+#ifdef SOLVER_FIXED_GEOMETRY
+#include "maze_geometry.h"
+#endif
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static SolverLogFn log_sink = NULL;
+
+static void adopt_speculation(Solver *s);
+static bool advance_plan(Solver *s, bool always_optimistic);
+
+// --- Direction Deltas (Consistent Order with Direction Enum) ---
+// Indexed by Direction enum: NORTH, EAST, SOUTH, WEST
+const Point direction_delta[DIRECTION_COUNT] = {
+    {0, 1},  // NORTH
+    {1, 0},  // EAST
+    {0, -1}, // SOUTH
+    {-1, 0}  // WEST
+};
+
+// --- Solver Lifecycle ---
+
+void solver_set_log(SolverLogFn fn) {
+    log_sink = fn;
+}
+
+// Returns false if the backend's maze is larger than this build supports
+bool solver_init(Solver *s, const MouseIO *io) {
+    s->io = io;
+    s->trace = NULL;
+    s->map_policy = MAP_IGNORE;
+    s->params = solver_default_params();
+    s->has_goal = false;
+    // Diagonal runs need every 45 degree hook, mms and the like stay orthogonal
+    s->planner.diagonals = io->move_half && io->turn_right_45 && io->turn_left_45 && io->move_diagonal;
+    PROF_RESET();
+    return solver_reset(s);
+}
+
+// Starts recording events into trace (NULL stops), beginning with the maze size
+void solver_set_trace(Solver *s, Trace *trace) {
+    s->trace = trace;
+    trace_record(trace, TRACE_INIT, s->maze.graph.width, s->maze.graph.height, 0, 0);
+}
+
+// Goal cells set with solver_set_goal win over the backend's, then the centre default
+static void apply_goal(Solver *s) {
+    const MouseIO *io = s->io;
+    Maze *m = &s->maze;
+    if (s->has_goal) {
+        if (!set_goal_cells(m, s->goal)) {
+            log_message("WARN: Goal cells are outside the maze or include the start, using the centre.");
+        }
+        return;
+    }
+    if (io->is_goal == NULL) return;
+
+    MazeRow cells[MAZE_MAX_HEIGHT] = {0};
+    for (int y = 0; y < m->graph.height; y++) {
+        for (int x = 0; x < m->graph.width; x++) {
+            if (io->is_goal(io->ctx, x, y)) cells[y] |= (MazeRow)(1u << x);
+        }
+    }
+    if (!set_goal_cells(m, cells)) {
+        log_message("WARN: Backend reports no goal cells or the start as one, using the centre.");
+    }
+}
+
+// Goal cells as rows like Maze.visited. They take effect at once and survive
+// resets; NULL goes back to the backend's goal (or the centre) on the next reset.
+// Returns false, changing nothing, if none of the cells is inside the maze or
+// the start cell is one of them
+bool solver_set_goal(Solver *s, const MazeRow *cells) {
+    if (cells == NULL) {
+        s->has_goal = false;
+        return true;
+    }
+    if (!set_goal_cells(&s->maze, cells)) {
+        log_message("ERROR: Goal cells are outside the maze or include the start.");
+        return false;
+    }
+    s->has_goal = true;
+    memcpy(s->goal, cells, sizeof(s->goal));
+    solver_flood_fill_goal(s);
+    return true;
+}
+
+SolverParams solver_default_params(void) {
+    return (SolverParams){.explore_bonus = EXPLORE_BONUS_DEFAULT,
+                          .min_verify_saving = VERIFY_SAVING_DEFAULT,
+                          .plan_budget = PLAN_BUDGET_DEFAULT};
+}
+
+// Takes effect at once and survives resets
+void solver_set_params(Solver *s, const SolverParams *params) {
+    s->params = *params;
+    s->mouse.explore_bonus = params->explore_bonus;
+}
+
+static void set_mode(Solver *s, RunMode mode) {
+    s->mouse.mode = mode;
+    trace_record(s->trace, TRACE_MODE, s->mouse.pos.x, s->mouse.pos.y, mode, 0);
+}
+
+// --- Map Persistence ---
+
+// Loads the backend's saved map into the fresh maze as map_policy says and
+// skips the search run. Returns false, keeping the empty map, if there is no
+// image or it does not check out.
+static bool restore_map(Solver *s) {
+    const MouseIO *io = s->io;
+    if (s->map_policy == MAP_IGNORE || io->load_map == NULL) return false;
+
+    uint8_t image[MAP_IMAGE_MAX];
+    int size = io->load_map(io->ctx, image, sizeof(image));
+    if (size <= 0) {
+        log_message("No saved map, starting a fresh search.");
+        return false;
+    }
+    if (!map_image_load(&s->maze, image, size, s->map_policy == MAP_TRUST)) {
+        log_message("WARN: Saved map is damaged or for another maze, starting a fresh search.");
+        return false;
+    }
+
+    log_message(s->map_policy == MAP_TRUST ? "=== Loaded saved map (trusted), planning the speed run ==="
+                                           : "=== Loaded saved map, verifying the best path ===");
+    s->mouse.goal_found = true;
+    set_mode(s, RETURN_MODE); // The exploration planner visits whatever the map leaves open
+    return true;
+}
+
+// Sets the policy for the backend's saved map and restarts with it.
+// Returns true if a saved map was loaded.
+bool solver_load_map(Solver *s, MapPolicy policy) {
+    s->map_policy = policy;
+    return solver_reset(s) && s->mouse.goal_found;
+}
+
+// Hands the current map to the backend's save_map, if it has one
+bool solver_save_map(Solver *s) {
+    const MouseIO *io = s->io;
+    if (io->save_map == NULL) return false;
+
+    uint8_t image[MAP_IMAGE_MAX];
+    int size = map_image_save(&s->maze, image, sizeof(image));
+    if (size == 0 || !io->save_map(io->ctx, image, size)) {
+        log_message("WARN: Could not save the map.");
+        return false;
+    }
+    s->saved_wall_version = s->maze.wall_version;
+    log_message("Map saved.");
+    return true;
+}
+
+// Saves only if walls were found since the last save
+static void save_map_if_changed(Solver *s) {
+    if (s->io->save_map && s->maze.wall_version != s->saved_wall_version) solver_save_map(s);
+}
+
+// Forgets everything learned so far and starts a new search from (0,0), or
+// from the backend's saved map under MAP_VERIFY / MAP_TRUST.
+// The maze size is queried again, a reset may come with a different maze.
+bool solver_reset(Solver *s) {
+    const MouseIO *io = s->io;
+    int width = io->maze_width(io->ctx);
+    int height = io->maze_height(io->ctx);
+
+    log_message("Initializing simulation state...");
+    if (!init_maze(&s->maze, width, height)) {
+        char buffer[100];
+        sprintf(buffer, "ERROR: %dx%d maze does not fit this build (3x3 to %dx%d)",
+                width, height, MAZE_MAX_WIDTH, MAZE_MAX_HEIGHT);
+        log_message(buffer);
+        return false;
+    }
+    apply_goal(s);
+    init_mouse(&s->mouse, &s->maze);
+    s->mouse.explore_bonus = s->params.explore_bonus;
+    memset(&s->speculation, 0, sizeof(s->speculation));
+    memset(&s->plan, 0, sizeof(s->plan));
+    trace_record(s->trace, TRACE_INIT, width, height, 0, 0);
+    s->saved_wall_version = restore_map(s) ? s->maze.wall_version : 0;
+    // Initial flood fill towards goal for the first search phase
+    solver_flood_fill_goal(s);
+    return true;
+}
+
+// One sense -> plan -> act cycle, or the next part of a plan spread over steps
+static bool run_step(Solver *s) {
+    const MouseIO *io = s->io;
+    MouseState *mouse = &s->mouse;
+    Maze *maze = &s->maze;
+
+    maze->cells_touched = 0; // Per-step fill cost, reported in the state line
+
+    if (io->was_reset && io->was_reset(io->ctx)) {
+        log_message("Simulator reset detected!");
+        if (io->ack_reset) io->ack_reset(io->ctx);
+        if (!solver_reset(s)) return false; // Reset everything
+        if (io->clear_display) io->clear_display(io->ctx); // Forget what was drawn for the old run
+    }
+
+    PROF_PHASE(mouse->mode);
+
+    // A step that goes on with a pending plan has nothing new to sense or draw
+    if (s->plan.stage == PLAN_IDLE) {
+        // 1. Sense Walls & Update Map
+        update_walls_current_cell(s);
+
+        // 2. Mark current cell as visited
+        set_visited(maze, mouse->pos);
+        adopt_speculation(s);
+
+        // 3. Update Display
+        PROF_SCOPE(PROF_UPDATE_DISPLAY) update_display(s);
+    }
+
+    // 4. State Machine Logic
+    switch (mouse->mode) {
+        case SEARCH_MODE:
+            if (mouse->has_explore_target && is_visited(maze, mouse->explore_target)) {
+                log_message("Exploration target visited, resuming search towards goal.");
+                mouse->has_explore_target = false;
+            }
+
+            if (is_at_goal(maze, mouse->pos) && is_at_start(mouse->pos)) {
+                // Nothing to search, return or race; set_goal_cells keeps this from happening
+                log_message("ERROR: The start cell is a goal cell, nothing to run.");
+                return false;
+            }
+            if (is_at_goal(maze, mouse->pos)) {
+                log_message("=== Goal reached! Switching to RETURN_MODE ===");
+                mouse->goal_found = true;
+                mouse->has_explore_target = false;
+                set_mode(s, RETURN_MODE);
+                solver_flood_fill_start(s); // Recalculate distances for return trip
+            } else {
+                if (mouse->has_explore_target) {
+                    solver_flood_fill(s, mouse->explore_target); // Head for the unexplored path cell
+                    if (maze_distance(maze, grid_index(mouse->pos)) == INVALID_DISTANCE) {
+                        log_message("Exploration target is walled off, resuming search towards goal.");
+                        mouse->has_explore_target = false;
+                    }
+                }
+                if (!mouse->has_explore_target) {
+                    solver_flood_fill_goal(s); // Ensure distances point towards goal
+                }
+                move_forward_update_state(s); // Decide and move
+            }
+            break;
+
+            case RETURN_MODE:
+                if (!mouse->exploration_done) {
+                    ExploreResult result = plan_exploration(s);
+                    if (result == EXPLORE_PENDING) break; // Planning goes on in the next step
+                    if (result == EXPLORE_TARGETS) {
+                        move_forward_update_state(s); // Head for the nearest cell that can shorten the run
+                        break;
+                    }
+                    log_message("=== Path bounds agree, exploration done! Returning to start ===");
+                    mouse->exploration_done = true;
+                }
+
+                if (is_at_start(mouse->pos)) {
+                    if (s->plan.stage == PLAN_IDLE) {
+                        log_message("=== Back at start! Preparing for speed run ===");
+                        // Optional: Final wall update at start
+                        update_walls_current_cell(s);
+                        solver_flood_fill_goal(s);
+                    }
+
+                    // Compute the shortest path over walls that have actually been sensed,
+                    // over unsensed ones only if that finds none
+                    bool planned = false;
+                    PROF_SCOPE(PROF_SHORTEST_PATH) planned = advance_plan(s, false);
+                    if (!planned) break; // Planning goes on in the next step
+                    uint32_t cost = s->plan.known_cost != PLAN_NO_PATH ? s->plan.known_cost : s->plan.optimistic_cost;
+                    trace_record(s->trace, TRACE_PLAN, mouse->pos.x, mouse->pos.y,
+                                 mouse->move_count > 255 ? 255 : mouse->move_count, cost);
+                    if (cost != PLAN_NO_PATH && mouse->optimistic_cost < cost) {
+                        char buffer[100];
+                        sprintf(buffer, "Speed run on known-open segments, unverified ones could save up to %lu ms",
+                                (unsigned long)(cost - mouse->optimistic_cost));
+                        log_message(buffer);
+                    }
+
+                    if (mouse->path_length > 0) { // Only verify if a path was actually found
+                        // Verify if the computed path is safe (only uses explored cells)
+                        bool verified = false;
+                        PROF_SCOPE(PROF_VERIFY_PATH) verified = verify_path_exploration(mouse, maze);
+                        if (verified) {
+                            // Path is safe, proceed to speed run
+                            log_message("=== Path verified! Switching to SPEED_MODE ===");
+                            set_mode(s, SPEED_MODE);
+                            save_map_if_changed(s); // Everything the speed run relies on
+                        } else {
+                            // Path is unsafe, needs more exploration along the computed path
+                            log_message("=== Path requires exploration! Returning to SEARCH_MODE ===");
+
+                            // Find the first cell on the path entered through an unsensed segment
+                            Point target_unvisited = mouse->pos; // Default to current if error
+                            CellIndex cell = grid_index((Point){0, 0});
+                            for (int i = 1; i < mouse->path_length; ++i) {
+                                Point prev = grid_point(cell);
+                                cell = grid_neighbor(cell, path_step(mouse, i - 1));
+                                Point p = grid_point(cell);
+                                if (!is_visited(maze, p) && !is_visited(maze, prev)) {
+                                    target_unvisited = p;
+                                    char buffer[100];
+                                    sprintf(buffer, "Targeting first unvisited cell on path: (%d,%d)", target_unvisited.x, target_unvisited.y);
+                                    log_message(buffer);
+                                    break;
+                                }
+                            }
+
+                            // Search towards the target unvisited cell until it has been visited
+                            mouse->exploration_done = false;
+                            mouse->has_explore_target = true;
+                            mouse->explore_target = target_unvisited;
+                            set_mode(s, SEARCH_MODE); // Go back to exploration mode
+                        }
+                    } else {
+                         log_message("ERROR: No path computed after returning to start. Cannot proceed.");
+                         // As a fallback, try searching again:
+                         log_message("Attempting to re-initiate search from start.");
+                         solver_flood_fill_goal(s);
+                         set_mode(s, SEARCH_MODE);
+                    }
+
+                } else {
+                    // Still returning to start
+                    solver_flood_fill_start(s); // Ensure distances point towards start
+                    move_forward_update_state(s); // Decide and move
+                }
+                break;
+
+            case SPEED_MODE:
+                 log_message("=== Beginning speed run ===");
+                 follow_shortest_path(s);
+                 save_map_if_changed(s); // A crash may have found a wall
+                 trace_record(s->trace, TRACE_STEP, mouse->pos.x, mouse->pos.y, mouse->orientation, 0);
+                 log_message("=== Speed run finished (check log for success/failure) ===");
+                 {
+                     char buffer[80];
+                     sprintf(buffer, "Flood fill cells touched over the run: %ld", maze->total_cells_touched);
+                     log_message(buffer);
+                     if (io->start_forward) {
+                         sprintf(buffer, "Search steps decided during motion: %d of %d planned",
+                                 s->speculation.hits, s->speculation.arrivals);
+                         log_message(buffer);
+                     }
+                     if (io->walls_ahead) {
+                         sprintf(buffer, "Cells sensed on entry: %d", s->speculation.early_readings);
+                         log_message(buffer);
+                     }
+                 }
+                 return false; // Run is over after the speed run attempt
+    }
+
+    // Only good for the step it was planned for, or the one a pending plan resumes in
+    if (s->plan.stage == PLAN_IDLE) s->speculation.have_choice = false;
+    PROF_COUNT(PROF_CELLS, (uint32_t)maze->cells_touched);
+    trace_record(s->trace, TRACE_STEP, mouse->pos.x, mouse->pos.y, mouse->orientation,
+                 (uint32_t)maze->cells_touched);
+    return true;
+}
+
+// Runs one step. Returns false once the speed run is over.
+// The work of a step is bounded by the maze size and, for the planner, by
+// SolverParams.plan_budget; what the planner would do beyond that is left for
+// the next steps. Profile builds record each step's time outside the backend.
+bool solver_step(Solver *s) {
+    PROF_STEP_BEGIN();
+    s->plan.budget = s->params.plan_budget;
+    bool more = run_step(s);
+    PROF_STEP_END();
+    if (!more) PROF_REPORT();
+    return more;
+}
+
+void solver_run(Solver *s) {
+    while (solver_step(s)) {
+    }
+}
+
+// --- Initialization Functions ---
+
+#ifdef SOLVER_FIXED_GEOMETRY
+// The generated empty maze: the tables stay in flash, the fields other than the
+// goal's are left stale for their first full rebuild
+static void init_maze_fixed(Maze *m) {
+    m->graph.width = GEOMETRY_WIDTH;
+    m->graph.height = GEOMETRY_HEIGHT;
+    memcpy(m->graph.flags, geometry_flags, sizeof(m->graph.flags));
+    memcpy(m->goal, geometry_goal, sizeof(m->goal));
+    memcpy(m->h_walls, geometry_h_walls, sizeof(m->h_walls));
+    memcpy(m->v_walls, geometry_v_walls, sizeof(m->v_walls));
+    memcpy(m->e_walls, geometry_e_walls, sizeof(m->e_walls));
+    memcpy(m->wall_log, geometry_wall_log, sizeof(geometry_wall_log));
+    m->wall_version = GEOMETRY_WALL_VERSION;
+
+    for (int slot = 0; slot < FIELD_COUNT; slot++) {
+        m->fields[slot].kind = FLOOD_NONE;
+        m->fields[slot].wall_version = 0;
+    }
+    DistanceField *goal = &m->fields[FIELD_GOAL];
+    memcpy(goal->distances, geometry_goal_distances, sizeof(goal->distances));
+    goal->kind = FLOOD_GOAL;
+    goal->wall_version = GEOMETRY_WALL_VERSION;
+    m->active_field = FIELD_GOAL;
+
+    memset(m->visited, 0, sizeof(m->visited));
+    memset(m->in_repair_stack, 0, sizeof(m->in_repair_stack));
+    m->repair_count = 0;
+    m->cells_touched = 0;
+    m->total_cells_touched = 0;
+}
+#endif
+
+bool init_maze(Maze *m, int width, int height) {
+#ifdef SOLVER_FIXED_GEOMETRY
+    if (width == GEOMETRY_WIDTH && height == GEOMETRY_HEIGHT) {
+        init_maze_fixed(m);
+        return true;
+    }
+#endif
+    if (!grid_init(&m->graph, width, height)) return false;
+    memset(m->goal, 0, sizeof(m->goal));
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (grid_is_goal(&m->graph, grid_index((Point){x, y}))) m->goal[y] |= (MazeRow)(1u << x);
+        }
+    }
+    for (int slot = 0; slot < FIELD_COUNT; slot++) {
+        DistanceField *f = &m->fields[slot];
+        for (int i = 0; i < GRID_CELLS; i++) {
+            f->distances[i] = INVALID_DISTANCE;
+        }
+        f->kind = FLOOD_NONE;
+        f->wall_version = 0;
+    }
+    m->active_field = FIELD_GOAL;
+    m->wall_version = 0;
+    // Assume no walls initially (except boundaries)
+    memset(m->h_walls, 0, sizeof(m->h_walls));
+    memset(m->v_walls, 0, sizeof(m->v_walls));
+    memset(m->e_walls, 0, sizeof(m->e_walls));
+    memset(m->visited, 0, sizeof(m->visited));
+    memset(m->in_repair_stack, 0, sizeof(m->in_repair_stack));
+    m->repair_count = 0;
+    m->cells_touched = 0;
+    m->total_cells_touched = 0;
+
+    // Set outer boundary walls
+    for (int i = 0; i < width; i++) {
+        set_wall(m, (Point){i, 0}, SOUTH);
+        set_wall(m, (Point){i, height - 1}, NORTH);
+    }
+    for (int i = 0; i < height; i++) {
+        set_wall(m, (Point){0, i}, WEST);
+        set_wall(m, (Point){width - 1, i}, EAST);
+    }
+    return true;
+}
+
+void init_mouse(MouseState *ms, Maze *m) {
+    ms->pos = (Point){0, 0};          // Start at (0,0)
+    ms->orientation = NORTH;          // Facing North initially
+    ms->mode = SEARCH_MODE;
+    ms->goal_found = false;
+    ms->has_explore_target = false;
+    ms->exploration_done = false;
+    ms->path_length = 0;
+    ms->move_count = 0;
+    ms->explore_bonus = EXPLORE_BONUS_DEFAULT;
+    ms->known_cost = ms->optimistic_cost = PLAN_NO_PATH;
+    set_visited(m, ms->pos); // Mark starting cell visited
+}
+
+// --- Coordinate and Boundary Checks ---
+
+bool is_within_bounds(const Maze *m, Point p) {
+    return grid_contains(&m->graph, p);
+}
+
+bool is_at_goal(const Maze *m, Point p) {
+    return is_within_bounds(m, p) && grid_is_goal(&m->graph, grid_index(p));
+}
+
+// Replaces the goal with the given cells (rows like visited), clipped to the maze.
+// Returns false, keeping the old goal, if none of them is inside it or the start
+// cell is one of them: the run would end before it began.
+bool set_goal_cells(Maze *m, const MazeRow *cells) {
+    if (cells[0] & 1u) return false;
+    MazeRow full = (MazeRow)(((m->graph.width < (int)(8 * sizeof(MazeRow))) ? (1u << m->graph.width) : 0u) - 1u);
+    MazeRow goal[MAZE_MAX_HEIGHT] = {0};
+    bool any = false;
+    for (int y = 0; y < m->graph.height; y++) {
+        goal[y] = cells[y] & full;
+        if (goal[y]) any = true;
+    }
+    if (!any) return false;
+
+    for (int y = 0; y < m->graph.height; y++) {
+        for (int x = 0; x < m->graph.width; x++) {
+            grid_set_goal(&m->graph, grid_index((Point){x, y}), (goal[y] >> x) & 1);
+        }
+    }
+    memcpy(m->goal, goal, sizeof(m->goal));
+    m->fields[FIELD_GOAL].kind = FLOOD_NONE; // Distances were to the old goal
+    return true;
+}
+
+bool is_at_start(Point p) {
+    return p.x == 0 && p.y == 0;
+}
+
+Direction get_opposite_direction(Direction dir) {
+    return grid_rotate(dir, 2);
+}
+
+// --- Visited Map ---
+
+bool is_visited(const Maze *m, Point p) {
+    return (m->visited[p.y] >> p.x) & 1;
+}
+
+void set_visited(Maze *m, Point p) {
+    m->visited[p.y] |= (MazeRow)(1u << p.x);
+    m->graph.flags[grid_index(p)] |= GRID_VISITED;
+}
+
+// --- Wall Management ---
+
+// Sets the walls of a MOUSE_WALL_* reading taken in cell p facing heading
+static void apply_wall_reading(Solver *s, Point p, Direction heading, uint8_t walls) {
+    static const struct {
+        uint8_t bit;
+        uint8_t quarter_turns; // Side relative to the heading
+    } sides[3] = {{MOUSE_WALL_FRONT, 0}, {MOUSE_WALL_RIGHT, 1}, {MOUSE_WALL_LEFT, 3}};
+    for (int i = 0; i < 3; i++) {
+        Direction dir = grid_rotate(heading, sides[i].quarter_turns);
+        if ((walls & sides[i].bit) && set_wall(&s->maze, p, dir)) {
+            trace_record(s->trace, TRACE_WALL, p.x, p.y, dir, 0);
+        }
+    }
+}
+
+// Updates walls for the current cell based on sensor readings, unless they
+// were pushed by walls_ahead on the way in
+void update_walls_current_cell(Solver *s) {
+    const MouseIO *io = s->io;
+    MouseState *ms = &s->mouse;
+    Speculation *sp = &s->speculation;
+    Point current_pos = ms->pos;
+
+    if (sp->ahead_sensed) {
+        sp->ahead_sensed = false;
+        if (sp->ahead_cell == grid_index(current_pos)) return;
+    }
+
+    uint8_t walls = 0;
+    if (io->read_walls) {
+        PROF_SCOPE(PROF_IO_SENSE) walls = io->read_walls(io->ctx);
+    } else {
+        bool front = false, right = false, left = false;
+        PROF_SCOPE(PROF_IO_SENSE) front = io->wall_front(io->ctx);
+        PROF_SCOPE(PROF_IO_SENSE) right = io->wall_right(io->ctx);
+        PROF_SCOPE(PROF_IO_SENSE) left = io->wall_left(io->ctx);
+        walls = (front ? MOUSE_WALL_FRONT : 0) | (right ? MOUSE_WALL_RIGHT : 0) | (left ? MOUSE_WALL_LEFT : 0);
+    }
+    apply_wall_reading(s, current_pos, ms->orientation, walls);
+
+    // Log detected walls (optional)
+    // char buffer[80];
+    // sprintf(buffer, "Walls at (%d,%d): N=%d E=%d S=%d W=%d",
+    //         current_pos.x, current_pos.y,
+    //         has_wall(m, current_pos, NORTH),
+    //         has_wall(m, current_pos, EAST),
+    //         has_wall(m, current_pos, SOUTH),
+    //         has_wall(m, current_pos, WEST));
+    // log_message(buffer);
+}
+
+// Locates the shared bit of the wall segment on side `dir` of cell p.
+// EAST/WEST live in v_walls indexed by column, NORTH/SOUTH in h_walls indexed by row;
+// NORTH and EAST are the far edge of the cell, i.e. the next row/column's word.
+#define WALL_IS_VERTICAL(dir) ((dir) & 1)
+#define WALL_LINE(p, dir) ((WALL_IS_VERTICAL(dir) ? (p).x : (p).y) + ((dir) < SOUTH))
+#define WALL_BIT(p, dir) (WALL_IS_VERTICAL(dir) ? (p).y : (p).x)
+
+// Sets a wall, which is also the neighbor's wall since segments are shared.
+// A newly discovered wall is logged so every cached distance field repairs it on next use.
+// Returns true if the segment was not known before.
+bool set_wall(Maze *m, Point p, Direction dir) {
+    if (!is_within_bounds(m, p)) return false;
+
+    MazeRow *plane = WALL_IS_VERTICAL(dir) ? m->v_walls : m->h_walls;
+    MazeRow mask = (MazeRow)(1u << WALL_BIT(p, dir));
+    MazeRow *word = &plane[WALL_LINE(p, dir)];
+    if (*word & mask) return false; // Already known, distances unaffected
+
+    *word |= mask;
+    if (dir == EAST) {
+        m->e_walls[p.y] |= (MazeRow)(1u << p.x);
+    } else if (dir == WEST && p.x > 0) {
+        m->e_walls[p.y] |= (MazeRow)(1u << (p.x - 1));
+    }
+    CellIndex c = grid_index(p);
+    grid_set_wall(&m->graph, c, dir);
+    m->wall_log[m->wall_version++] = (uint16_t)(c * DIRECTION_COUNT + dir);
+    return true;
+}
+
+// Checks if a wall exists from the maze's perspective
+bool has_wall(const Maze *m, Point p, Direction dir) {
+    if (!is_within_bounds(m, p)) return true; // Treat out of bounds as walls
+    const MazeRow *plane = WALL_IS_VERTICAL(dir) ? m->v_walls : m->h_walls;
+    return (plane[WALL_LINE(p, dir)] >> WALL_BIT(p, dir)) & 1;
+}
+
+// Unknown, known open or walled, out of bounds counts as walled
+WallState wall_state(const Maze *m, Point p, Direction dir) {
+    if (!is_within_bounds(m, p)) return WALL_PRESENT;
+    return grid_wall_state(&m->graph, grid_index(p), dir);
+}
+
+
+// --- Flood Fill Algorithm (Manhattan Distance) ---
+
+// Queues a cell whose distance may no longer match its neighbours
+void push_repair(Maze *m, CellIndex c) {
+    Point p = grid_point(c);
+    MazeRow mask = (MazeRow)(1u << p.x);
+    if (m->in_repair_stack[p.y] & mask) return;
+    m->in_repair_stack[p.y] |= mask;
+    m->repair_stack[m->repair_count++] = c;
+}
+
+// Checks if a cell is a zero-distance seed of a distance field
+bool is_flood_target(const Maze *m, const DistanceField *f, CellIndex c) {
+    if (f->kind == FLOOD_GOAL) return grid_is_goal(&m->graph, c);
+    if (f->kind == FLOOD_CELLS) {
+        Point p = grid_point(c);
+        return (f->cells[p.y] >> p.x) & 1;
+    }
+    return c == grid_index(f->target);
+}
+
+// Queues both cells of every segment logged since the field was last consistent
+static void queue_new_walls(Maze *m, const DistanceField *f) {
+    for (int i = f->wall_version; i < m->wall_version; i++) {
+        CellIndex c = m->wall_log[i] / DIRECTION_COUNT;
+        Direction side = (Direction)(m->wall_log[i] % DIRECTION_COUNT);
+        push_repair(m, c);
+
+        // The neighbor's distance may depend on this segment too
+        CellIndex neighbor = grid_neighbor(c, side);
+        if (!(m->graph.flags[neighbor] & GRID_BORDER)) {
+            push_repair(m, neighbor);
+        }
+    }
+}
+
+// Modified flood fill: catches the field up with the walls found since it was last
+// used and restores distance[c] == 1 + min(open neighbours) for every queued cell,
+// re-queuing the neighbours of any cell whose value changed.
+// Returns false if the cascade exceeded REPAIR_BUDGET and a full BFS is needed.
+bool flood_fill_repair(Maze *m, DistanceField *f) {
+    int budget = REPAIR_BUDGET(m);
+    queue_new_walls(m, f);
+
+    while (m->repair_count > 0) {
+        if (budget-- == 0) return false;
+
+        CellIndex current = m->repair_stack[--m->repair_count];
+        Point p = grid_point(current);
+        m->in_repair_stack[p.y] &= (MazeRow)~(1u << p.x);
+        m->cells_touched++;
+        m->total_cells_touched++;
+
+        if (is_flood_target(m, f, current)) continue; // Seeds stay at 0
+
+        int min_neighbor = INVALID_DISTANCE;
+        for (Direction dir = 0; dir < DIRECTION_COUNT; dir++) {
+            if (grid_has_wall(&m->graph, current, dir)) continue;
+            int neighbor_dist = f->distances[grid_neighbor(current, dir)];
+            if (neighbor_dist < min_neighbor) min_neighbor = neighbor_dist;
+        }
+
+        // Cells cut off from the target saturate at INVALID_DISTANCE
+        int new_dist = min_neighbor < INVALID_DISTANCE ? min_neighbor + 1 : INVALID_DISTANCE;
+        if (f->distances[current] == new_dist) continue;
+        f->distances[current] = new_dist;
+
+        // Neighbours reachable from this cell may now be inconsistent too
+        for (Direction dir = 0; dir < DIRECTION_COUNT; dir++) {
+            if (!grid_has_wall(&m->graph, current, dir)) {
+                push_repair(m, grid_neighbor(current, dir));
+            }
+        }
+    }
+    f->wall_version = m->wall_version;
+    return true;
+}
+
+// Clears any pending repairs before a full rebuild of a distance field
+void reset_repair_stack(Maze *m) {
+    m->repair_count = 0;
+    memset(m->in_repair_stack, 0, sizeof(m->in_repair_stack));
+}
+
+// Breadth-first search from a set of seed cells (bitboard rows like visited).
+// The outer walls keep it inside the maze, so the loop has no bounds checks.
+void flood_fill_queue(Maze *m, DistanceField *f, const MazeRow *seeds) {
+    CellIndex *queue = m->queue;
+    int q_head = 0, q_tail = 0;
+    for (int y = 0; y < m->graph.height; y++) {
+        for (MazeRow row = seeds[y]; row != 0; row &= (MazeRow)(row - 1)) {
+            CellIndex seed = grid_index((Point){__builtin_ctz(row), y});
+            f->distances[seed] = 0;
+            queue[q_tail++] = seed;
+        }
+    }
+
+    while (q_head < q_tail) {
+        CellIndex current = queue[q_head++];
+        m->cells_touched++;
+        m->total_cells_touched++;
+        uint16_t next_dist = f->distances[current] + 1;
+        uint8_t walls = m->graph.flags[current];
+
+        // Explore neighbors; a neighbor with a higher distance gets updated
+        for (Direction dir = 0; dir < DIRECTION_COUNT; dir++) {
+            if ((walls >> dir) & 1) continue;
+            CellIndex neighbor = grid_neighbor(current, dir);
+            if (f->distances[neighbor] > next_dist) {
+                f->distances[neighbor] = next_dist;
+                queue[q_tail++] = neighbor; // Add neighbor to queue
+            }
+        }
+    }
+    f->wall_version = m->wall_version;
+}
+
+// Same search as a wavefront of row words: each distance layer is one bitboard,
+// grown a cell in every open direction by shifts masked with the walls, over the
+// rows it can reach. Like the queue BFS it relies on the outer walls (e_walls has
+// bit width-1 set) to keep the shifts inside the maze.
+void flood_fill_wavefront(Maze *m, DistanceField *f, const MazeRow *seeds) {
+    int height = m->graph.height;
+    MazeRow rows[MAZE_MAX_HEIGHT + 2] = {0}; // One empty row either side of the maze
+    MazeRow reached[MAZE_MAX_HEIGHT];
+    MazeRow *layer = rows + 1;
+    int touched = 0;
+
+    int lo = height, hi = -1;
+    for (int y = 0; y < height; y++) {
+        layer[y] = reached[y] = seeds[y];
+        if (!seeds[y]) continue;
+        if (lo > y) lo = y;
+        hi = y;
+        for (MazeRow row = seeds[y]; row != 0; row &= (MazeRow)(row - 1)) {
+            f->distances[grid_index((Point){__builtin_ctz(row), y})] = 0;
+            touched++;
+        }
+    }
+
+    for (uint16_t dist = 1; lo <= hi; dist++) {
+        int from = lo > 0 ? lo - 1 : 0, to = hi + 1 < height ? hi + 1 : height - 1;
+        MazeRow below = layer[from - 1]; // Row y-1 of the previous layer
+        lo = height;
+        hi = -1;
+        for (int y = from; y <= to; y++) {
+            MazeRow here = layer[y];
+            MazeRow open_sides = (MazeRow)~m->e_walls[y];
+            MazeRow grown = (MazeRow)(((here & open_sides) << 1) | ((here >> 1) & open_sides) |
+                                      (below & (MazeRow)~m->h_walls[y]) |
+                                      (layer[y + 1] & (MazeRow)~m->h_walls[y + 1]));
+            grown &= (MazeRow)~reached[y];
+            below = here;
+            layer[y] = grown;
+            if (!grown) continue;
+            reached[y] |= grown;
+            if (lo > y) lo = y;
+            hi = y;
+            for (MazeRow row = grown; row != 0; row &= (MazeRow)(row - 1)) {
+                f->distances[grid_index((Point){__builtin_ctz(row), y})] = dist;
+                touched++;
+            }
+        }
+    }
+    m->cells_touched += touched;
+    m->total_cells_touched += touched;
+    f->wall_version = m->wall_version;
+}
+
+#ifdef SOLVER_FLOOD_WAVEFRONT
+#define flood_fill_engine flood_fill_wavefront
+#else
+#define flood_fill_engine flood_fill_queue
+#endif
+
+// Prepares a full rebuild: no pending repairs, every distance infinite
+static void flood_fill_clear(Maze *m, DistanceField *f) {
+    reset_repair_stack(m);
+    f->kind = FLOOD_NONE;
+    for (int i = 0; i < GRID_CELLS; i++) {
+        f->distances[i] = INVALID_DISTANCE;
+    }
+}
+
+// General flood fill from a target point, the start cell or an explore target.
+// Reuses the cached field if it already describes the same target.
+void flood_fill(Maze *m, Point target) {
+    m->active_field = is_at_start(target) ? FIELD_START : FIELD_TARGET;
+    DistanceField *f = &m->fields[m->active_field];
+    if (f->kind == FLOOD_POINT && f->target.x == target.x && f->target.y == target.y &&
+        flood_fill_repair(m, f)) {
+        return;
+    }
+
+    flood_fill_clear(m, f);
+
+    if (!is_within_bounds(m, target)) {
+        log_message("ERROR: Flood fill target out of bounds!");
+        return;
+    }
+    MazeRow seeds[MAZE_MAX_HEIGHT] = {0};
+    seeds[target.y] = (MazeRow)(1u << target.x);
+    f->kind = FLOOD_POINT;
+    f->target = target;
+
+    flood_fill_engine(m, f, seeds);
+}
+
+// Flood fill towards the goal cells, all of them at once
+void flood_fill_goal(Maze *m) {
+    m->active_field = FIELD_GOAL;
+    DistanceField *f = &m->fields[FIELD_GOAL];
+    if (f->kind == FLOOD_GOAL && flood_fill_repair(m, f)) {
+        return;
+    }
+
+    bool any_goal = false;
+    flood_fill_clear(m, f);
+
+    // One multi-source BFS from every goal cell, whatever areas they form
+    for (int y = 0; y < m->graph.height; y++) {
+        if (m->goal[y]) any_goal = true;
+    }
+
+    if (!any_goal) {
+        log_message("ERROR: No valid goal cells found for flood fill!");
+        return;
+    }
+    f->kind = FLOOD_GOAL;
+
+    flood_fill_engine(m, f, m->goal);
+}
+
+
+// Flood fill targeting the start cell (0,0)
+void flood_fill_start(Maze *m) {
+    flood_fill(m, (Point){0, 0});
+}
+
+// Turns the cached cell-set field into one for a new set: dropped seeds are
+// repaired like cells behind a new wall, added seeds drop to 0 and queue their
+// neighbours. Returns false if a full BFS is needed instead.
+static bool flood_fill_update_cells(Maze *m, DistanceField *f, const MazeRow *cells) {
+    for (int y = 0; y < m->graph.height; y++) {
+        MazeRow changed = f->cells[y] ^ cells[y];
+        for (int x = 0; changed != 0; x++, changed >>= 1) {
+            if (!(changed & 1)) continue;
+            CellIndex c = grid_index((Point){x, y});
+            if ((cells[y] >> x) & 1) {
+                f->distances[c] = 0;
+                for (Direction dir = 0; dir < DIRECTION_COUNT; dir++) {
+                    if (!grid_has_wall(&m->graph, c, dir)) push_repair(m, grid_neighbor(c, dir));
+                }
+            } else {
+                push_repair(m, c);
+            }
+        }
+    }
+    memcpy(f->cells, cells, sizeof(f->cells));
+    return flood_fill_repair(m, f);
+}
+
+// Flood fill from a set of cells (bitboard rows like visited), so every cell
+// gets the distance to the nearest of them
+void flood_fill_cells(Maze *m, const MazeRow *cells) {
+    m->active_field = FIELD_TARGET;
+    DistanceField *f = &m->fields[FIELD_TARGET];
+    bool any_cell = false;
+    for (int y = 0; y < m->graph.height; y++) {
+        if (cells[y]) any_cell = true;
+    }
+    if (f->kind == FLOOD_CELLS && any_cell && flood_fill_update_cells(m, f, cells)) {
+        return;
+    }
+
+    flood_fill_clear(m, f);
+    if (!any_cell) {
+        log_message("ERROR: Flood fill target set is empty!");
+        return;
+    }
+    memcpy(f->cells, cells, sizeof(f->cells));
+    f->kind = FLOOD_CELLS;
+
+    flood_fill_engine(m, f, cells);
+}
+
+// Records the fill that just ran, touched = cells_touched before it
+static void trace_flood(const Solver *s, int touched) {
+    trace_record(s->trace, TRACE_FLOOD, s->mouse.pos.x, s->mouse.pos.y, s->maze.active_field,
+                 (uint32_t)(s->maze.cells_touched - touched));
+}
+
+// Fills bracketed by the backend's optional timing hooks
+void solver_flood_fill(Solver *s, Point target) {
+    const MouseIO *io = s->io;
+    int touched = s->maze.cells_touched;
+    if (io->flood_fill_begin) io->flood_fill_begin(io->ctx);
+    PROF_SCOPE(PROF_FLOOD_FILL) flood_fill(&s->maze, target);
+    if (io->flood_fill_end) io->flood_fill_end(io->ctx);
+    trace_flood(s, touched);
+}
+
+void solver_flood_fill_goal(Solver *s) {
+    const MouseIO *io = s->io;
+    int touched = s->maze.cells_touched;
+    if (io->flood_fill_begin) io->flood_fill_begin(io->ctx);
+    PROF_SCOPE(PROF_FLOOD_FILL) flood_fill_goal(&s->maze);
+    if (io->flood_fill_end) io->flood_fill_end(io->ctx);
+    trace_flood(s, touched);
+}
+
+void solver_flood_fill_start(Solver *s) {
+    solver_flood_fill(s, (Point){0, 0});
+}
+
+void solver_flood_fill_cells(Solver *s, const MazeRow *cells) {
+    const MouseIO *io = s->io;
+    int touched = s->maze.cells_touched;
+    if (io->flood_fill_begin) io->flood_fill_begin(io->ctx);
+    PROF_SCOPE(PROF_FLOOD_FILL) flood_fill_cells(&s->maze, cells);
+    if (io->flood_fill_end) io->flood_fill_end(io->ctx);
+    trace_flood(s, touched);
+}
+
+
+// --- Movement Logic ---
+
+// Picks the open neighbour of pos with the lowest distance. In SEARCH_MODE, adds a
+// small bias towards unvisited cells. Returns false if every side is walled.
+static bool pick_direction(const MouseState *ms, const Maze *m, const uint16_t *distances, Point pos,
+                           Direction *best_dir) {
+    CellIndex current = grid_index(pos);
+    int min_dist = INT_MAX; // Higher than any distance, whatever the bonus
+    bool found_move = false;
+
+    // Check all four directions
+    for (Direction dir = 0; dir < DIRECTION_COUNT; dir++) {
+        // Skip if there's a wall
+        if (grid_has_wall(&m->graph, current, dir)) {
+            continue;
+        }
+
+        CellIndex neighbor = grid_neighbor(current, dir);
+        int neighbor_dist = distances[neighbor];
+
+        // Add exploration bonus in SEARCH_MODE to prefer unvisited cells slightly
+        int adjusted_dist = neighbor_dist;
+        if (ms->mode == SEARCH_MODE && !is_visited(m, grid_point(neighbor))) {
+             // Make unvisited significantly more attractive than visited cells with the *same* base distance.
+             // If an unvisited cell has a higher base distance, we still prefer lower distance overall.
+             adjusted_dist -= ms->explore_bonus; // SolverParams.explore_bonus, 1 by default
+        }
+
+
+        // If this neighbor has a lower (potentially adjusted) distance, it's the new best
+        if (adjusted_dist < min_dist) {
+            min_dist = adjusted_dist;
+            *best_dir = dir;
+            found_move = true;
+        }
+    }
+    return found_move;
+}
+
+// Decides the best direction to move next based on flood fill distances
+Direction choose_next_direction(const MouseState *ms, const Maze *m) {
+    Direction best_dir = NORTH; // Default, should be overridden
+    if (!pick_direction(ms, m, m->fields[m->active_field].distances, ms->pos, &best_dir)) {
+        // This should ideally not happen if flood fill is correct and there's a path
+        log_message("ERROR: No valid move found! Stuck?");
+        // If stuck, maybe turn around as a fallback?
+        best_dir = get_opposite_direction(ms->orientation);
+    }
+
+    return best_dir;
+}
+
+// --- Speculative Planning ---
+
+// Field of the leg worth planning ahead: the plain search or return trip, -1 otherwise
+static int speculation_field(const MouseState *ms) {
+    if (ms->mode == SEARCH_MODE && !ms->has_explore_target) return FIELD_GOAL;
+    if (ms->mode == RETURN_MODE && ms->exploration_done) return FIELD_START;
+    return -1;
+}
+
+// Plans the next step for both outcomes of the segment ahead of the cell the mouse
+// is driving into. Runs between start_forward and finish_forward, while the motors
+// do the work. Arrivals that change mode are left alone.
+static void speculate(Solver *s) {
+    Speculation *sp = &s->speculation;
+    const MouseState *ms = &s->mouse;
+    Maze *m = &s->maze;
+    sp->ready = false;
+
+    int slot = speculation_field(ms);
+    if (slot < 0) return;
+    DistanceField *f = &m->fields[slot];
+    CellIndex cell = grid_neighbor(grid_index(ms->pos), ms->orientation);
+    Point arrival = grid_point(cell);
+    if (m->active_field != slot || f->wall_version != m->wall_version || is_at_goal(m, arrival) ||
+        is_at_start(arrival)) {
+        return;
+    }
+
+    sp->cell = cell;
+    sp->side = ms->orientation;
+    sp->field = slot;
+    sp->wall_version = m->wall_version;
+    if (!pick_direction(ms, m, f->distances, arrival, &sp->open_dir)) return;
+    sp->arrivals++;
+    sp->ready = true;
+
+    // The walled candidate: the same field repaired as if the segment were set
+    sp->has_walled = false;
+    if (grid_has_wall(&m->graph, cell, sp->side) || grid_is_known(&m->graph, cell, sp->side)) return;
+    memcpy(&sp->walled, f, sizeof(sp->walled));
+    grid_set_wall(&m->graph, cell, sp->side);
+    push_repair(m, cell);
+    push_repair(m, grid_neighbor(cell, sp->side));
+    if (flood_fill_repair(m, &sp->walled)) {
+        sp->has_walled = pick_direction(ms, m, sp->walled.distances, arrival, &sp->walled_dir);
+    } else {
+        reset_repair_stack(m);
+    }
+    grid_clear_wall(&m->graph, cell, sp->side);
+}
+
+// Called once the arrival cell has been sensed: takes the planned decision if the
+// map matches one of the candidates, installing the walled field if that was it
+static void adopt_speculation(Solver *s) {
+    Speculation *sp = &s->speculation;
+    const MouseState *ms = &s->mouse;
+    Maze *m = &s->maze;
+    sp->have_choice = false;
+    if (!sp->ready) return;
+    sp->ready = false;
+
+    if (grid_index(ms->pos) != sp->cell || speculation_field(ms) != sp->field) return;
+
+    int new_walls = m->wall_version - sp->wall_version;
+    if (new_walls == 0) {
+        sp->choice = sp->open_dir;
+    } else if (new_walls == 1 && sp->has_walled &&
+               m->wall_log[sp->wall_version] == sp->cell * DIRECTION_COUNT + sp->side) {
+        DistanceField *f = &m->fields[sp->field];
+        memcpy(f->distances, sp->walled.distances, sizeof(f->distances));
+        f->wall_version = m->wall_version;
+        sp->choice = sp->walled_dir;
+    } else {
+        return;
+    }
+    sp->have_choice = true;
+    sp->hits++;
+}
+
+// Polls walls_ahead once for the cell the mouse is driving into and puts the
+// reading on the map at once. Called after the speculation was planned, so the
+// new walls show up as the arrival's sensing and the planned decision still fits
+static void take_walls_ahead(Solver *s) {
+    const MouseIO *io = s->io;
+    const MouseState *ms = &s->mouse;
+    Speculation *sp = &s->speculation;
+    if (io->walls_ahead == NULL || sp->ahead_sensed) return;
+
+    uint8_t walls = 0;
+    bool ready = false;
+    PROF_SCOPE(PROF_IO_SENSE) ready = io->walls_ahead(io->ctx, &walls);
+    if (!ready) return;
+    CellIndex cell = grid_neighbor(grid_index(ms->pos), ms->orientation);
+    apply_wall_reading(s, grid_point(cell), ms->orientation, walls);
+    sp->ahead_sensed = true;
+    sp->ahead_cell = cell;
+    sp->early_readings++;
+}
+
+// Turns the mouse to face the target direction using minimal turns
+void turn_to_direction(Solver *s, Direction target_dir) {
+    const MouseIO *io = s->io;
+    MouseState *ms = &s->mouse;
+    if (ms->orientation == target_dir) {
+        return; // Already facing the right way
+    }
+
+    int diff = grid_turns_between(ms->orientation, target_dir);
+
+    if (diff == 1) { // 90 degrees right
+        PROF_SCOPE(PROF_IO_MOTION) io->turn_right(io->ctx);
+        ms->orientation = grid_rotate(ms->orientation, 1);
+    } else if (diff == 3) { // 90 degrees left (270 right)
+        PROF_SCOPE(PROF_IO_MOTION) io->turn_left(io->ctx);
+        ms->orientation = grid_rotate(ms->orientation, 3);
+    } else { // 180 degrees
+        PROF_SCOPE(PROF_IO_MOTION) io->turn_right(io->ctx);
+        ms->orientation = grid_rotate(ms->orientation, 1);
+        PROF_SCOPE(PROF_IO_MOTION) io->turn_right(io->ctx);
+        ms->orientation = grid_rotate(ms->orientation, 1);
+    }
+    trace_record(s->trace, TRACE_TURN, ms->pos.x, ms->pos.y, ms->orientation, (uint32_t)diff);
+}
+
+// Chooses direction, turns, moves forward, and updates state.
+// Handles unexpected walls discovered during movement.
+void move_forward_update_state(Solver *s) {
+    const MouseIO *io = s->io;
+    MouseState *ms = &s->mouse;
+    Maze *m = &s->maze;
+
+    // 1. Decide where to go, unless it was planned during the last move
+    Direction next_dir = NORTH;
+    if (s->speculation.have_choice) {
+        next_dir = s->speculation.choice;
+        s->speculation.have_choice = false;
+    } else {
+        PROF_SCOPE(PROF_CHOOSE_DIRECTION) next_dir = choose_next_direction(ms, m);
+    }
+
+    // 2. Turn to face that direction
+    turn_to_direction(s, next_dir);
+
+    // 3. Attempt to move forward, planning the arrival on the way if the backend can
+    bool moved = false;
+    if (io->start_forward && io->finish_forward) {
+        PROF_SCOPE(PROF_IO_MOTION) io->start_forward(io->ctx);
+        speculate(s);
+        take_walls_ahead(s);
+        PROF_SCOPE(PROF_IO_MOTION) moved = io->finish_forward(io->ctx);
+        if (moved) take_walls_ahead(s); // Readings that came in late in the move
+    } else {
+        PROF_SCOPE(PROF_IO_MOTION) moved = io->move_forward(io->ctx);
+    }
+    if (moved) {
+        // 4a. Move successful: Update mouse position
+        ms->pos.x += direction_delta[ms->orientation].x;
+        ms->pos.y += direction_delta[ms->orientation].y;
+        trace_record(s->trace, TRACE_MOVE, ms->pos.x, ms->pos.y, ms->orientation, 1);
+    } else {
+        // 4b. Move failed: Hit an unexpected wall
+        s->speculation.ahead_sensed = false; // Never entered, nothing was read ahead
+        log_message("WARN: Move failed - unexpected wall detected!");
+        trace_record(s->trace, TRACE_CRASH, ms->pos.x, ms->pos.y, ms->orientation, 0);
+        if (set_wall(m, ms->pos, ms->orientation)) { // Update wall map
+            trace_record(s->trace, TRACE_WALL, ms->pos.x, ms->pos.y, ms->orientation, 0);
+        }
+
+        // Re-run flood fill as the distances are now potentially incorrect
+        if (ms->mode == SEARCH_MODE) {
+             log_message("Recalculating distances to goal due to new wall.");
+             solver_flood_fill_goal(s);
+        } else if (ms->mode == RETURN_MODE) {
+             log_message("Recalculating distances to start due to new wall.");
+             solver_flood_fill_start(s);
+        }
+         // We don't move, stay in the same cell for the next iteration
+    }
+}
+
+
+// --- Pathfinding and Following ---
+
+// Time to drive n cells straight from standstill to standstill (180mm cells,
+// 4 m/s^2 acceleration, 1.5 m/s top speed), so long straights are cheaper per cell
+static const uint16_t straight_cost[32] = {
+    0,    425,  600,  735,  855,  975,  1096, 1215, 1335, 1455, 1575,
+    1695, 1816, 1935, 2055, 2175, 2295, 2415, 2535, 2655, 2775, 2895,
+    3015, 3135, 3256, 3375, 3495, 3615, 3735, 3855, 3975, 4096};
+
+// Same profile over n half-diagonals (127mm each), from one cell edge midpoint to another
+static const uint16_t diagonal_cost[64] = {
+    0,    357,  505,  618,  714,  799,  884,  969,  1054, 1139, 1224, 1308, 1393,
+    1478, 1563, 1648, 1733, 1817, 1902, 1987, 2072, 2157, 2242, 2327, 2411, 2496,
+    2581, 2666, 2751, 2836, 2921, 3005, 3090, 3175, 3260, 3345, 3430, 3515, 3599,
+    3684, 3769, 3854, 3939, 4024, 4109, 4193, 4278, 4363, 4448, 4533, 4618, 4702,
+    4787, 4872, 4957, 5042, 5127, 5212, 5296, 5381, 5466, 5551, 5636, 5721};
+
+_Static_assert(sizeof(straight_cost) / sizeof(straight_cost[0]) >= MAZE_MAX_WIDTH &&
+                   sizeof(straight_cost) / sizeof(straight_cost[0]) >= MAZE_MAX_HEIGHT,
+               "straight_cost must cover the longest straight");
+_Static_assert(sizeof(diagonal_cost) / sizeof(diagonal_cost[0]) >= MAZE_MAX_WIDTH + MAZE_MAX_HEIGHT - 2,
+               "diagonal_cost must cover the longest diagonal run");
+
+// A staircase of `steps` single-cell steps cut diagonally: half a cell and 45 degrees
+// onto the diagonal, steps - 1 half-diagonals, 45 degrees and half a cell off it
+static uint32_t diagonal_run_cost(int steps) {
+    return 2 * (HALF_CELL_COST + TURN_45_COST) + diagonal_cost[steps - 1];
+}
+
+// Heading of step i of a diagonal run that starts along `heading` and first turns to `side`
+static Direction diagonal_step(Direction heading, Direction side, int i) {
+    return i % 2 == 0 ? heading : side;
+}
+
+#define PLANNER_CLOSED 0xFFFF
+
+// A* priority: cost so far plus the goal field distance at top speed (never overestimates)
+static uint32_t planner_priority(const PathPlanner *pp, const Maze *m, uint16_t state) {
+    const uint16_t *to_goal = m->fields[FIELD_GOAL].distances;
+    uint32_t per_cell = pp->diagonals ? DIAGONAL_CELL_COST_AT_VMAX : CELL_COST_AT_VMAX;
+    return pp->cost[state] + (uint32_t)to_goal[state / DIRECTION_COUNT] * per_cell;
+}
+
+static void planner_swap(PathPlanner *pp, int i, int j) {
+    uint16_t tmp = pp->heap[i];
+    pp->heap[i] = pp->heap[j];
+    pp->heap[j] = tmp;
+    pp->heap_pos[pp->heap[i]] = (uint16_t)(i + 1);
+    pp->heap_pos[pp->heap[j]] = (uint16_t)(j + 1);
+}
+
+static void planner_sift_up(PathPlanner *pp, const Maze *m, int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (planner_priority(pp, m, pp->heap[parent]) <= planner_priority(pp, m, pp->heap[i])) break;
+        planner_swap(pp, i, parent);
+        i = parent;
+    }
+}
+
+static uint16_t planner_pop(PathPlanner *pp, const Maze *m) {
+    uint16_t top = pp->heap[0];
+    pp->heap_pos[top] = PLANNER_CLOSED;
+    if (--pp->heap_size == 0) return top;
+    pp->heap[0] = pp->heap[pp->heap_size];
+    pp->heap_pos[pp->heap[0]] = 1;
+
+    int i = 0;
+    while (true) {
+        int smallest = i;
+        for (int child = 2 * i + 1; child <= 2 * i + 2 && child < pp->heap_size; child++) {
+            if (planner_priority(pp, m, pp->heap[child]) < planner_priority(pp, m, pp->heap[smallest])) {
+                smallest = child;
+            }
+        }
+        if (smallest == i) break;
+        planner_swap(pp, i, smallest);
+        i = smallest;
+    }
+    return top;
+}
+
+// Relaxes the edge into `state`, queuing it or decreasing its key
+static void planner_relax(PathPlanner *pp, const Maze *m, uint16_t from, uint16_t state, uint32_t cost,
+                          uint8_t via) {
+    if (pp->heap_pos[state] == PLANNER_CLOSED || cost >= pp->cost[state]) return;
+    pp->cost[state] = cost;
+    pp->parent[state] = from;
+    pp->via[state] = via;
+    if (pp->heap_pos[state] == 0) {
+        pp->heap[pp->heap_size] = state;
+        pp->heap_pos[state] = (uint16_t)(++pp->heap_size);
+    }
+    planner_sift_up(pp, m, pp->heap_pos[state] - 1);
+}
+
+// Starts a search for the fastest path from start (0,0), facing NORTH, to the goal
+// area on the current maze map; planner_expand runs it and planner_finish turns it
+// into the path. Edges are in-place turns and straights of any length, priced by
+// the cost model above, so a path with fewer turns wins over a slightly shorter
+// zig-zag. Unsensed wall segments count as open, or as closed when known_only is
+// set. Returns false if the start cannot reach the goal, there is nothing to search.
+bool planner_begin(Maze *m, PathPlanner *pp, bool known_only) {
+    log_message("Computing shortest path from start to goal...");
+
+    // Distances to the goal double as the A* heuristic
+    flood_fill_goal(m);
+
+    pp->known_only = known_only;
+    pp->goal_state = -1;
+    pp->heap_size = 0;
+
+    // Check if start cell is reachable
+    CellIndex start_cell = grid_index((Point){0, 0});
+    if (m->fields[FIELD_GOAL].distances[start_cell] == INVALID_DISTANCE) {
+         log_message("ERROR: Start cell is unreachable from goal!");
+         return false;
+    }
+
+    for (int i = 0; i < PLANNER_STATES; i++) {
+        pp->cost[i] = UINT32_MAX;
+        pp->heap_pos[i] = 0;
+    }
+
+    pp->start = (uint16_t)(start_cell * DIRECTION_COUNT + NORTH);
+    planner_relax(pp, m, pp->start, pp->start, 0, 0);
+    return true;
+}
+
+// Expands up to *budget states (every one if budget is NULL), taking them off
+// *budget. Returns true once the search is over: the goal was reached or
+// nothing is left to expand. The maze must not change while a search is open.
+bool planner_expand(PathPlanner *pp, const Maze *m, int *budget) {
+    bool known_only = pp->known_only;
+    while (pp->goal_state < 0 && pp->heap_size > 0) {
+        if (budget && *budget <= 0) return false;
+        if (budget) (*budget)--;
+
+        uint16_t state = planner_pop(pp, m);
+        CellIndex cell = state / DIRECTION_COUNT;
+        Direction heading = (Direction)(state % DIRECTION_COUNT);
+        if (grid_is_goal(&m->graph, cell)) {
+            pp->goal_state = state;
+            break;
+        }
+
+        uint16_t base = (uint16_t)(state - heading);
+        uint32_t cost = pp->cost[state];
+        planner_relax(pp, m, state, base + grid_rotate(heading, 1), cost + TURN_90_COST, 0);
+        planner_relax(pp, m, state, base + grid_rotate(heading, 3), cost + TURN_90_COST, 0);
+        planner_relax(pp, m, state, base + grid_rotate(heading, 2), cost + TURN_180_COST, 0);
+
+        // Straights of every length up to the next known wall
+        CellIndex next = cell;
+        for (int n = 1; grid_can_cross(&m->graph, next, heading, known_only); n++) {
+            next = grid_neighbor(next, heading);
+            planner_relax(pp, m, state, (uint16_t)(next * DIRECTION_COUNT + heading), cost + straight_cost[n], 0);
+        }
+        if (!pp->diagonals) continue;
+
+        // Diagonal runs: staircases that start along the heading, first step right or left
+        for (int turn = 1; turn <= 3; turn += 2) {
+            Direction side = grid_rotate(heading, turn);
+            next = cell;
+            for (int n = 0;; n++) {
+                Direction step = diagonal_step(heading, side, n);
+                if (!grid_can_cross(&m->graph, next, step, known_only)) break;
+                next = grid_neighbor(next, step);
+                if (n + 1 >= DIAGONAL_MIN_STEPS) {
+                    planner_relax(pp, m, state, (uint16_t)(next * DIRECTION_COUNT + step),
+                                  cost + diagonal_run_cost(n + 1),
+                                  (uint8_t)((n + 1) | (turn == 3 ? PLANNER_VIA_LEFT : 0)));
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Stores the path a finished search found in ms, compiled into moves. Returns its
+// cost, PLAN_NO_PATH (and an empty path) if the search found none.
+uint32_t planner_finish(MouseState *ms, PathPlanner *pp) {
+    ms->path_length = 0;
+    ms->move_count = 0;
+    int goal_state = pp->goal_state;
+    uint16_t start = pp->start;
+    if (goal_state < 0) {
+        if (!pp->known_only) log_message("ERROR: Could not find next step while computing shortest path! Path broken?");
+        return PLAN_NO_PATH;
+    }
+
+    // Walk the parents back to the start; every state change is a turn, a straight
+    // or a diagonal run (counted as its two 45 degree turns)
+    int cells = 1, turns = 0;
+    for (uint16_t state = (uint16_t)goal_state; state != start; state = pp->parent[state]) {
+        uint16_t from = pp->parent[state];
+        if (pp->via[state]) {
+            cells += pp->via[state] & ~PLANNER_VIA_LEFT;
+            turns += 2;
+        } else if (from / DIRECTION_COUNT == state / DIRECTION_COUNT) {
+            turns++;
+        } else {
+            Point a = grid_point(from / DIRECTION_COUNT), b = grid_point(state / DIRECTION_COUNT);
+            cells += abs(b.x - a.x) + abs(b.y - a.y);
+        }
+    }
+    if (cells > MAX_CELLS) {
+         log_message("ERROR: Shortest path exceeds maximum length!");
+         return PLAN_NO_PATH;
+    }
+
+    // Fill the path steps back to front, expanding each straight and staircase into its cells
+    ms->path_length = cells;
+    int index = cells - 1; // Cell the current edge ends in, its step is index - 1
+    for (uint16_t state = (uint16_t)goal_state; state != start; state = pp->parent[state]) {
+        uint16_t from = pp->parent[state];
+        CellIndex a = from / DIRECTION_COUNT, c = state / DIRECTION_COUNT;
+        Direction heading = (Direction)(state % DIRECTION_COUNT);
+        if (pp->via[state]) {
+            int steps = pp->via[state] & ~PLANNER_VIA_LEFT;
+            Direction start_heading = (Direction)(from % DIRECTION_COUNT);
+            Direction side = (Direction)((start_heading + ((pp->via[state] & PLANNER_VIA_LEFT) ? 3 : 1)) %
+                                         DIRECTION_COUNT);
+            index -= steps;
+            for (int n = 0; n < steps; n++) {
+                set_path_step(ms, index + n, diagonal_step(start_heading, side, n));
+            }
+            continue;
+        }
+        while (c != a) {
+            set_path_step(ms, --index, heading);
+            c = grid_neighbor(c, get_opposite_direction(heading));
+        }
+    }
+    compile_moves(ms, pp->diagonals);
+
+    char buffer[160];
+    sprintf(buffer, "Shortest %spath computed with %d steps (length %d including start), %d turns, %d moves, est. %lu ms.",
+            pp->known_only ? "known " : "", ms->path_length - 1, ms->path_length, turns, ms->move_count,
+            (unsigned long)pp->cost[goal_state]);
+    log_message(buffer);
+    return pp->cost[goal_state];
+}
+
+// The whole search of planner_begin at once. Returns the path cost, PLAN_NO_PATH
+// (and an empty path) if the goal is unreachable.
+uint32_t compute_shortest_path(MouseState *ms, Maze *m, PathPlanner *pp, bool known_only) {
+    if (!planner_begin(m, pp, known_only)) {
+        ms->path_length = 0;
+        ms->move_count = 0;
+        return PLAN_NO_PATH;
+    }
+    planner_expand(pp, m, NULL);
+    return planner_finish(ms, pp);
+}
+
+// Goes on with the open plan, or opens one, within what is left of this step's
+// plan budget: the known-only path first, then the optimistic one if always_optimistic
+// or no known path exists. A stage only starts while budget is left, so a step
+// never opens a search it cannot expand. Returns false while the plan needs more
+// steps; once true the costs are in s->plan and the path is the last one planned.
+static bool advance_plan(Solver *s, bool always_optimistic) {
+    PlanJob *job = &s->plan;
+    PathPlanner *pp = &s->planner;
+    int *budget = s->params.plan_budget > 0 ? &job->budget : NULL;
+    if (job->stage == PLAN_IDLE) {
+        job->stage = PLAN_KNOWN;
+        job->started = false;
+        job->steps = 0;
+        job->known_cost = job->optimistic_cost = PLAN_NO_PATH;
+    }
+    job->steps++;
+
+    for (;;) {
+        if (!job->started) {
+            if (budget && *budget <= 0) return false;
+            job->open = planner_begin(&s->maze, pp, job->stage == PLAN_KNOWN);
+            job->started = true;
+        }
+        uint32_t cost = PLAN_NO_PATH;
+        if (job->open) {
+            if (!planner_expand(pp, &s->maze, budget)) return false;
+            cost = planner_finish(&s->mouse, pp);
+        } else {
+            s->mouse.path_length = 0;
+            s->mouse.move_count = 0;
+        }
+
+        if (job->stage == PLAN_OPTIMISTIC) {
+            job->optimistic_cost = cost;
+            break;
+        }
+        job->known_cost = cost;
+        if (!always_optimistic && s->mouse.path_length > 0) break;
+        job->stage = PLAN_OPTIMISTIC;
+        job->started = false;
+    }
+
+    job->stage = PLAN_IDLE;
+    if (job->steps > 1) {
+        char buffer[60];
+        sprintf(buffer, "Plan spread over %d steps", job->steps);
+        log_message(buffer);
+    }
+    return true;
+}
+
+// Bounds the speed run from both sides: the optimistic path treats unsensed walls
+// as open, the pessimistic one as closed. While they differ by more than
+// SolverParams.min_verify_saving, the unvisited cells on the optimistic path are
+// the only ones that can still improve the run, so the distances are pointed at
+// them. Returns EXPLORE_DONE once the bounds are close enough.
+ExploreResult plan_exploration(Solver *s) {
+    MouseState *ms = &s->mouse;
+    Maze *m = &s->maze;
+
+    if (s->plan.stage == PLAN_IDLE) solver_flood_fill_goal(s); // Heuristic for both plans
+    bool planned = false;
+    PROF_SCOPE(PROF_SHORTEST_PATH) planned = advance_plan(s, true);
+    if (!planned) return EXPLORE_PENDING;
+    uint32_t pessimistic = s->plan.known_cost, optimistic = s->plan.optimistic_cost;
+
+    MazeRow targets[MAZE_MAX_HEIGHT] = {0};
+    bool any_target = false;
+    CellIndex cell = grid_index((Point){0, 0});
+    for (int i = 0; i < ms->path_length; i++) {
+        if (i > 0) cell = grid_neighbor(cell, path_step(ms, i - 1));
+        Point p = grid_point(cell);
+        if (!is_visited(m, p)) {
+            targets[p.y] |= (MazeRow)(1u << p.x);
+            any_target = true;
+        }
+    }
+
+    ms->known_cost = pessimistic;
+    ms->optimistic_cost = optimistic;
+    char buffer[100];
+    sprintf(buffer, "Exploration bounds: optimistic %lu ms, pessimistic %lu ms",
+            (unsigned long)optimistic, (unsigned long)pessimistic);
+    log_message(buffer);
+    if (optimistic == PLAN_NO_PATH || pessimistic == optimistic || !any_target) {
+        return EXPLORE_DONE;
+    }
+    // Not worth the trip: a known path exists and the unverified one saves too little
+    if (pessimistic != PLAN_NO_PATH && pessimistic - optimistic <= s->params.min_verify_saving) {
+        sprintf(buffer, "Unverified segments would save only %lu ms, keeping the known path",
+                (unsigned long)(pessimistic - optimistic));
+        log_message(buffer);
+        return EXPLORE_DONE;
+    }
+
+    solver_flood_fill_cells(s, targets);
+    return EXPLORE_TARGETS;
+}
+
+// Checks if the current computed shortest path only crosses sensed, open wall segments.
+bool verify_path_exploration(const MouseState *ms, const Maze *m) {
+    if (ms->path_length <= 1) {
+        log_message("Path verification: Path is too short or invalid.");
+        return false; // Cannot run speed mode on an empty/single-cell path
+    }
+
+    log_message("Verifying path exploration...");
+    // A cell never stood on is fine as long as the segment it is entered by has been sensed.
+    // The outer walls keep the walk inside the maze.
+    CellIndex cell = grid_index((Point){0, 0});
+    for (int i = 0; i + 1 < ms->path_length; ++i) {
+        Direction move_dir = path_step(ms, i);
+        if (grid_wall_state(&m->graph, cell, move_dir) != WALL_OPEN) {
+            Point prev_p = grid_point(cell), p = grid_point(grid_neighbor(cell, move_dir));
+            char buffer[120];
+            sprintf(buffer, "Path verification FAILED: Transition from (%d,%d) to (%d,%d) uses unknown/walled path segment.", prev_p.x, prev_p.y, p.x, p.y);
+            log_message(buffer);
+            return false;
+        }
+        cell = grid_neighbor(cell, move_dir);
+    }
+
+    log_message("Path verification PASSED: Path is fully explored.");
+    return true; // Every segment on the path is known open
+}
+
+// Compresses the shortest path into straight runs and in-place turns, starting from
+// (0,0) facing NORTH. With diagonals, every staircase of at least DIAGONAL_MIN_STEPS
+// alternating single-cell steps becomes a diagonal run instead.
+void compile_moves(MouseState *ms, bool diagonals) {
+    int count = ms->path_length - 1;
+    ms->move_count = 0;
+
+    Direction heading = NORTH;
+    for (int i = 0; i < count; i++) {
+        Direction move_dir = path_step(ms, i);
+
+        // Longest staircase starting here: perpendicular steps, every other one the same
+        int run = 1;
+        while (diagonals && i + run < count &&
+               (path_step(ms, i + run) - path_step(ms, i + run - 1) + DIRECTION_COUNT) % 2 == 1 &&
+               (run < 2 || path_step(ms, i + run) == path_step(ms, i + run - 2))) {
+            run++;
+        }
+
+        int diff = grid_turns_between(heading, move_dir);
+        if (diff != 0) {
+            ms->moves[ms->move_count++] = (Move){diff == 1 ? MOVE_RIGHT : diff == 3 ? MOVE_LEFT : MOVE_AROUND, 0};
+            heading = move_dir;
+        }
+
+        if (run >= DIAGONAL_MIN_STEPS) {
+            bool right = grid_turns_between(move_dir, path_step(ms, i + 1)) == 1;
+            // Leaving along the entry heading turns back, leaving along the side keeps turning
+            bool exit_right = (run % 2 == 1) != right;
+            ms->moves[ms->move_count++] = (Move){right ? MOVE_ENTER_RIGHT_45 : MOVE_ENTER_LEFT_45, 0};
+            ms->moves[ms->move_count++] = (Move){MOVE_DIAGONAL, (uint8_t)(run - 1)};
+            ms->moves[ms->move_count++] = (Move){exit_right ? MOVE_EXIT_RIGHT_45 : MOVE_EXIT_LEFT_45, 0};
+            heading = path_step(ms, i + run - 1);
+            i += run - 1;
+            continue;
+        }
+
+        Move *last = ms->move_count > 0 ? &ms->moves[ms->move_count - 1] : NULL;
+        if (last && last->kind == MOVE_FORWARD) {
+            last->count++;
+        } else {
+            ms->moves[ms->move_count++] = (Move){MOVE_FORWARD, 1};
+        }
+    }
+}
+
+// Drives `cells` straight ahead, as one motion if the backend supports it
+static bool drive_straight(Solver *s, int cells) {
+    const MouseIO *io = s->io;
+    MouseState *ms = &s->mouse;
+
+    bool moved = true;
+    if (io->move_forward_n && cells > 1) {
+        PROF_SCOPE(PROF_IO_MOTION) moved = io->move_forward_n(io->ctx, cells);
+        if (!moved) return false;
+        ms->pos.x += direction_delta[ms->orientation].x * cells;
+        ms->pos.y += direction_delta[ms->orientation].y * cells;
+        trace_record(s->trace, TRACE_MOVE, ms->pos.x, ms->pos.y, ms->orientation, (uint32_t)cells);
+        return true;
+    }
+
+    for (int i = 0; i < cells; i++) {
+        PROF_SCOPE(PROF_IO_MOTION) moved = io->move_forward(io->ctx);
+        if (!moved) return false;
+        ms->pos.x += direction_delta[ms->orientation].x;
+        ms->pos.y += direction_delta[ms->orientation].y;
+        trace_record(s->trace, TRACE_MOVE, ms->pos.x, ms->pos.y, ms->orientation, 1);
+    }
+    return true;
+}
+
+// Drives the diagonal run that starts at moves[0] (enter, MOVE_DIAGONAL, exit), from
+// the centre of the current cell to the centre of the staircase's last cell
+static bool drive_diagonal(Solver *s, const Move *moves) {
+    const MouseIO *io = s->io;
+    MouseState *ms = &s->mouse;
+    Direction heading = ms->orientation;
+    int turn = moves[0].kind == MOVE_ENTER_RIGHT_45 ? 1 : 3;
+    Direction side = grid_rotate(heading, turn);
+
+    bool moved = false;
+    PROF_SCOPE(PROF_IO_MOTION) moved = io->move_half(io->ctx);
+    if (!moved) return false;
+    ms->pos.x += direction_delta[heading].x;
+    ms->pos.y += direction_delta[heading].y;
+    trace_record(s->trace, TRACE_MOVE, ms->pos.x, ms->pos.y, ms->orientation, 1);
+    PROF_SCOPE(PROF_IO_MOTION) (turn == 1 ? io->turn_right_45 : io->turn_left_45)(io->ctx);
+
+    // Each half-diagonal crosses into the next staircase cell, alternating side and heading
+    PROF_SCOPE(PROF_IO_MOTION) moved = io->move_diagonal(io->ctx, moves[1].count);
+    if (!moved) return false;
+    for (int n = 1; n <= moves[1].count; n++) {
+        ms->orientation = diagonal_step(heading, side, n);
+        ms->pos.x += direction_delta[ms->orientation].x;
+        ms->pos.y += direction_delta[ms->orientation].y;
+    }
+    trace_record(s->trace, TRACE_MOVE, ms->pos.x, ms->pos.y, ms->orientation, moves[1].count);
+
+    PROF_SCOPE(PROF_IO_MOTION) (moves[2].kind == MOVE_EXIT_RIGHT_45 ? io->turn_right_45 : io->turn_left_45)(io->ctx);
+    PROF_SCOPE(PROF_IO_MOTION) moved = io->move_half(io->ctx);
+    return moved;
+}
+
+// Executes the speed run as the compiled sequence of straights, turns and diagonal runs
+void follow_shortest_path(Solver *s) {
+    const MouseIO *io = s->io;
+    MouseState *ms = &s->mouse;
+    Maze *m = &s->maze;
+
+    log_message("Starting speed run execution...");
+
+     // Ensure mouse is at start and facing North (or a default direction)
+     if (!is_at_start(ms->pos)) {
+        log_message("ERROR: Cannot start speed run, mouse not at (0,0)!");
+        return; // Or potentially navigate back to start first
+     }
+     turn_to_direction(s, NORTH); // Ensure consistent starting orientation
+
+
+    if (ms->path_length <= 1 || ms->move_count == 0) {
+        log_message("WARN: No valid path computed for speed run.");
+        return;
+    }
+
+    for (int i = 0; i < ms->move_count; i++) {
+        Move move = ms->moves[i];
+        switch (move.kind) {
+            case MOVE_RIGHT:
+                turn_to_direction(s, grid_rotate(ms->orientation, 1));
+                break;
+            case MOVE_LEFT:
+                turn_to_direction(s, grid_rotate(ms->orientation, 3));
+                break;
+            case MOVE_AROUND:
+                turn_to_direction(s, get_opposite_direction(ms->orientation));
+                break;
+            case MOVE_ENTER_RIGHT_45:
+            case MOVE_ENTER_LEFT_45: {
+                Point from = ms->pos;
+                if (i + 2 >= ms->move_count || !drive_diagonal(s, &ms->moves[i])) {
+                    char buffer[120];
+                    trace_record(s->trace, TRACE_CRASH, ms->pos.x, ms->pos.y, ms->orientation, 0);
+                    sprintf(buffer, "FATAL ERROR: Speed run failed! Hit unexpected wall on the diagonal from (%d,%d). Map is wrong!",
+                            from.x, from.y);
+                    log_message(buffer);
+                    PROF_SCOPE(PROF_UPDATE_DISPLAY) update_display(s);
+                    return;
+                }
+                i += 2; // The run's MOVE_DIAGONAL and exit turn
+                PROF_SCOPE(PROF_UPDATE_DISPLAY) update_display(s);
+                break;
+            }
+            case MOVE_FORWARD: {
+                // Expecting no walls along the computed path
+                Point from = ms->pos;
+                if (!drive_straight(s, move.count)) {
+                    // This indicates a major inconsistency between the computed path and reality
+                    char buffer[120];
+                    trace_record(s->trace, TRACE_CRASH, ms->pos.x, ms->pos.y, ms->orientation, 0);
+                    sprintf(buffer, "FATAL ERROR: Speed run failed! Hit unexpected wall on the straight from (%d,%d) facing %d. Map is wrong!",
+                            from.x, from.y, ms->orientation);
+                    log_message(buffer);
+                    // A single-cell move tells us exactly where the wall is
+                    if ((move.count == 1 || !io->move_forward_n) && set_wall(m, ms->pos, ms->orientation)) {
+                        trace_record(s->trace, TRACE_WALL, ms->pos.x, ms->pos.y, ms->orientation, 0);
+                    }
+                    PROF_SCOPE(PROF_UPDATE_DISPLAY) update_display(s);
+                    // Abort speed run? Or try to recompute? For now, abort.
+                    return;
+                }
+                PROF_SCOPE(PROF_UPDATE_DISPLAY) update_display(s); // Update display after each straight
+                break;
+            }
+        }
+    }
+
+    // Check if we actually ended up in a goal cell
+    if (is_at_goal(m, ms->pos)) {
+         log_message("=== Speed run complete! Goal successfully reached! ===");
+         if (io->set_color) io->set_color(io->ctx, ms->pos.x, ms->pos.y, 'G'); // Final confirmation color
+    } else {
+         log_message("ERROR: Speed run finished, but not at a goal cell!");
+    }
+}
+
+
+// --- Utility Functions ---
+
+// Updates the backend's display, if it has one
+void update_display(const Solver *s) {
+#ifndef SOLVER_NO_DISPLAY
+    const MouseIO *io = s->io;
+    const MouseState *ms = &s->mouse;
+    const Maze *m = &s->maze;
+    // Headless or embedded target, nothing to draw. Each hook is optional on its own
+    if (io->set_color == NULL && io->set_text == NULL && io->set_wall == NULL) return;
+
+    // Path cells, highlighted during the speed run
+    MazeRow on_path[MAZE_MAX_HEIGHT] = {0};
+    if (ms->mode == SPEED_MODE && ms->path_length > 0) {
+        CellIndex cell = grid_index((Point){0, 0});
+        for (int i = 0; i < ms->path_length; i++) {
+            if (i > 0) cell = grid_neighbor(cell, path_step(ms, i - 1));
+            Point p = grid_point(cell);
+            on_path[p.y] |= (MazeRow)(1u << p.x);
+        }
+    }
+
+    // Repaints every cell; the display layer only sends what changed since the last call
+
+    for (int x = 0; x < m->graph.width; x++) {
+        for (int y = 0; y < m->graph.height; y++) {
+            Point p = {x, y};
+            // Set text (distance value)
+            int distance = maze_distance(m, grid_index(p));
+            if (io->set_text && distance == INVALID_DISTANCE) {
+                io->set_text(io->ctx, x, y, "-");
+            } else if (io->set_text) {
+                char buffer[8];
+                sprintf(buffer, "%d", distance);
+                io->set_text(io->ctx, x, y, buffer);
+            }
+
+            // Pick cell color based on state (sent once, only if it changed)
+            char color;
+            if (p.x == ms->pos.x && p.y == ms->pos.y) {
+                color = 'R'; // Current mouse position: Red
+            } else if (is_at_goal(m, p)) {
+                color = 'G'; // Goal cells: Green
+            } else if (is_visited(m, p)) {
+                color = 'B'; // Visited cells: Blue
+            } else {
+                color = 'Y'; // Unvisited cells: Yellow
+            }
+
+            // Don't overwrite current pos or goal color
+            if (((on_path[y] >> x) & 1) && !(p.x == ms->pos.x && p.y == ms->pos.y) && !is_at_goal(m, p)) {
+                color = 'C'; // Path cells: Cyan
+            }
+            if (io->set_color) io->set_color(io->ctx, x, y, color);
+
+            // Draw known walls
+            if (io->set_wall == NULL) continue;
+            if (has_wall(m, p, NORTH)) io->set_wall(io->ctx, x, y, 'n');
+            if (has_wall(m, p, EAST)) io->set_wall(io->ctx, x, y, 'e');
+            if (has_wall(m, p, SOUTH)) io->set_wall(io->ctx, x, y, 's');
+            if (has_wall(m, p, WEST)) io->set_wall(io->ctx, x, y, 'w');
+        }
+    }
+#else
+    (void)s;
+#endif
+}
+
+// Hands a message to the log sink set with solver_set_log
+void log_message(const char *msg) {
+    if (log_sink) log_sink(msg);
+}
@@ -0,0 +1,353 @@
+#pragma once
+#include "grid.h"
+#include "mouse_io.h"
+#include "trace.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// solver.h
+// Flood-fill maze solver core shared by every backend.
+// All state lives in a Solver (maze knowledge + mouse state + backend), so
+// any number of independent solvers can run in one process. Sensing,
+// motion and drawing go through the MouseIO the solver was created with.
+
+// --- Constants ---
+#define INVALID_DISTANCE (MAX_CELLS) // Represents infinity
+// Incremental repairs that cascade past this many cells fall back to a full BFS
+#define REPAIR_BUDGET(m) (2 * (m)->graph.width * (m)->graph.height)
+// Every wall segment of the largest maze, the most set_wall can ever log
+#define MAZE_WALL_SEGMENTS ((MAZE_MAX_WIDTH + 1) * MAZE_MAX_HEIGHT + (MAZE_MAX_HEIGHT + 1) * MAZE_MAX_WIDTH)
+
+// Speed run cost model (milliseconds) for a mouse that stops for every in-place turn.
+// Straights of n cells cost straight_cost[n] in solver.c, a trapezoidal profile.
+#define TURN_90_COST 300
+#define TURN_180_COST 500
+#define CELL_COST_AT_VMAX 120 // Lower bound on the per-cell straight cost, used as A* heuristic
+// Diagonal runs cut a staircase of alternating single-cell steps from edge midpoint to
+// edge midpoint, half-diagonals cost diagonal_cost[n] in solver.c.
+#define HALF_CELL_COST 300
+#define TURN_45_COST 200
+#define DIAGONAL_MIN_STEPS 3          // Shortest staircase a diagonal run beats
+#define DIAGONAL_CELL_COST_AT_VMAX 84 // Per-cell lower bound once diagonals are allowed
+#define PLANNER_STATES (GRID_CELLS * DIRECTION_COUNT)
+// Search heuristic defaults, see SolverParams
+#define EXPLORE_BONUS_DEFAULT 1 // Distance credit of an unvisited neighbour
+#define VERIFY_SAVING_DEFAULT 0 // Explore while unverified segments save anything at all
+#define PLAN_BUDGET_DEFAULT 0   // No limit, every plan finishes in the step that starts it
+#define PLAN_NO_PATH UINT32_MAX
+#define PLANNER_VIA_LEFT 0x40 // PathPlanner.via: the diagonal run's first step turns left
+
+// Fixed buffers and index types, checked against the build's capacity
+#if PLANNER_STATES >= 0xFFFF
+#error "Planner state ids must fit uint16_t below PLANNER_CLOSED"
+#endif
+#if MAZE_WALL_SEGMENTS > 0xFFFF
+#error "Maze.wall_version must count every wall segment in a uint16_t"
+#endif
+#if MAZE_MAX_WIDTH + MAZE_MAX_HEIGHT - 2 >= PLANNER_VIA_LEFT
+#error "A diagonal run's step count must fit below PLANNER_VIA_LEFT"
+#endif
+
+// --- Enums ---
+typedef enum {
+    SEARCH_MODE, // Explore to find the goal
+    RETURN_MODE, // Return to start after finding the goal
+    SPEED_MODE   // Fast run from start to goal using known path
+} RunMode;
+
+typedef enum {
+    MOVE_FORWARD, // Move.count cells straight ahead
+    MOVE_RIGHT,   // 90 degrees in place
+    MOVE_LEFT,
+    MOVE_AROUND,  // 180 degrees in place
+    // Diagonal runs, always compiled as enter, MOVE_DIAGONAL, exit
+    MOVE_ENTER_RIGHT_45, // Half a cell to the edge ahead, then 45 degrees right
+    MOVE_ENTER_LEFT_45,
+    MOVE_DIAGONAL,       // Move.count half-diagonals, each from one cell edge to the next
+    MOVE_EXIT_RIGHT_45,  // 45 degrees right back onto an axis, then half a cell to the centre
+    MOVE_EXIT_LEFT_45
+} MoveKind;
+
+typedef enum {
+    FLOOD_NONE,  // Distances are stale, the next fill must be a full BFS
+    FLOOD_GOAL,  // Distances to the nearest goal cell, any goal area
+    FLOOD_POINT, // Distances to DistanceField.target
+    FLOOD_CELLS  // Distances to the nearest cell of DistanceField.cells
+} FloodKind;
+
+// Cached distance fields, one per kind of destination
+typedef enum {
+    FIELD_GOAL,   // Goal cells: search runs and the speed run heuristic
+    FIELD_START,  // Start cell: return trips
+    FIELD_TARGET, // Explore target, a single cell or a set of cells
+    FIELD_COUNT
+} FieldSlot;
+
+// What solver_reset does with a map image from the backend's load_map
+typedef enum {
+    MAP_IGNORE, // Always start with an empty map
+    MAP_VERIFY, // Load the walls, then visit the best path's cells before the speed run
+    MAP_TRUST   // Load walls and visited cells, go to the speed run if they settle the path
+} MapPolicy;
+
+// --- Structs ---
+
+// One motion primitive of the compiled speed run
+typedef struct {
+    uint8_t kind;  // MoveKind
+    uint8_t count; // Cells for MOVE_FORWARD, half-diagonals for MOVE_DIAGONAL
+} Move;
+
+// The shortest path is kept as the direction of each step from (0,0), two bits
+// per step, instead of a Point per cell
+#define PATH_STEP_BYTES ((MAX_CELLS + 3) / 4)
+
+// Holds the mouse's current state
+typedef struct {
+    Point pos;
+    Direction orientation;
+    RunMode mode;
+    bool goal_found;
+    bool has_explore_target;        // Searching towards explore_target instead of the goal
+    Point explore_target;           // First unvisited cell of a speed run path that failed verification
+    bool exploration_done;          // Optimistic and pessimistic path bounds agree
+    uint8_t path_steps[PATH_STEP_BYTES]; // Shortest path from (0,0), see path_step
+    int path_length;                // Cells on the path, including (0,0)
+    Move moves[MAX_CELLS];          // Path compiled into straights, turns and diagonal runs
+    int move_count;
+    int explore_bonus;              // SolverParams.explore_bonus of the run
+    // Speed run cost bounds of the last plan_exploration (ms, PLAN_NO_PATH if none):
+    // over known-open segments only, and with unknown ones taken as open
+    uint32_t known_cost, optimistic_cost;
+} MouseState;
+
+// Row/column bitboard word, one bit per cell along a row (or column)
+#if MAZE_MAX_SIZE <= 16
+typedef uint16_t MazeRow;
+#else
+typedef uint32_t MazeRow;
+#endif
+
+// One cached distance field. Its distances match the walls up to wall_version;
+// segments logged after that are repaired the next time the field is used.
+typedef struct {
+    uint16_t distances[GRID_CELLS]; // Flood fill distances by CellIndex
+    FloodKind kind;                 // Target the distances describe
+    Point target;                   // Target cell when kind == FLOOD_POINT
+    MazeRow cells[MAZE_MAX_HEIGHT]; // Target cells when kind == FLOOD_CELLS, same layout as visited
+    uint16_t wall_version;          // Maze.wall_version the distances were last made consistent with
+} DistanceField;
+
+// Holds the maze's discovered state.
+// Every wall segment is stored once and shared by the two cells it separates:
+//   h_walls[y] bit x -> wall on the SOUTH side of (x,y), h_walls[height] is the top edge
+//   v_walls[x] bit y -> wall on the WEST side of (x,y),  v_walls[width] is the right edge
+// The same walls are mirrored into graph, the per-cell view the search loops walk,
+// and into e_walls, the row-major view the wavefront flood fill shifts through.
+typedef struct {
+    MazeRow h_walls[MAZE_MAX_HEIGHT + 1];        // Horizontal wall segments
+    MazeRow v_walls[MAZE_MAX_WIDTH + 1];         // Vertical wall segments
+    MazeRow e_walls[MAZE_MAX_HEIGHT];            // v_walls by row: bit x -> wall on the EAST side of (x,y)
+    MazeRow visited[MAZE_MAX_HEIGHT];            // visited[y] bit x -> (x,y) visited during search
+    CellGraph graph;                             // Maze size, known walls and goal mask per cell
+    MazeRow goal[MAZE_MAX_HEIGHT];               // Goal cells, same layout as visited; the seeds of FIELD_GOAL
+
+    // Incremental flood fill bookkeeping
+    DistanceField fields[FIELD_COUNT];        // Cached distances per destination
+    int active_field;                         // FieldSlot the mouse is currently following
+    uint16_t wall_log[MAZE_WALL_SEGMENTS];    // CellIndex * DIRECTION_COUNT + side of each new segment, in order
+    uint16_t wall_version;                    // Segments logged so far
+    // Flood fill scratch. A full BFS always starts with the repair stack cleared and a
+    // repair never queues, so both live in one buffer, kept off the stack
+    union {
+        CellIndex queue[MAX_CELLS];        // BFS work queue, every cell is queued at most once
+        CellIndex repair_stack[MAX_CELLS]; // Cells that may be inconsistent after a new wall
+    };
+    MazeRow in_repair_stack[MAZE_MAX_HEIGHT]; // Same layout as visited
+    int repair_count;
+    int cells_touched;                        // Cells processed by fills during the current step
+    long total_cells_touched;                 // Cells processed by fills since init
+} Maze;
+
+// Direction of step i of the shortest path, from cell i to cell i + 1
+static inline Direction path_step(const MouseState *ms, int i) {
+    return (Direction)((ms->path_steps[i / 4] >> (2 * (i % 4))) & 3);
+}
+
+static inline void set_path_step(MouseState *ms, int i, Direction dir) {
+    int shift = 2 * (i % 4);
+    ms->path_steps[i / 4] = (uint8_t)((ms->path_steps[i / 4] & ~(3u << shift)) | ((unsigned)dir << shift));
+}
+
+// Distance of cell c in the field the mouse is following
+static inline uint16_t maze_distance(const Maze *m, CellIndex c) {
+    return m->fields[m->active_field].distances[c];
+}
+
+// Scratch space of the speed run planner, an A* search over (cell, heading) states.
+// State id = CellIndex * DIRECTION_COUNT + heading.
+typedef struct {
+    uint32_t cost[PLANNER_STATES];     // Best known cost from the start state
+    uint16_t parent[PLANNER_STATES];   // Previous state on that best path
+    uint8_t via[PLANNER_STATES];       // Edge from parent: 0 turn or straight, else diagonal run steps
+    uint16_t heap[PLANNER_STATES];     // Open set, binary min-heap on cost + heuristic
+    uint16_t heap_pos[PLANNER_STATES]; // Heap index + 1, 0 if never queued, PLANNER_CLOSED once expanded
+    int heap_size;
+    bool diagonals; // Also plan diagonal runs, set when the backend has the 45 degree hooks
+    // The open search, see planner_begin
+    bool known_only;
+    uint16_t start;
+    int goal_state; // -1 until the goal is reached
+} PathPlanner;
+
+typedef enum {
+    PLAN_IDLE,       // No plan open
+    PLAN_KNOWN,      // Planning over known-open segments only
+    PLAN_OPTIMISTIC  // Planning with unsensed segments taken as open
+} PlanStage;
+
+// The speed run plans (known-only, then optimistic) in progress. With a
+// SolverParams.plan_budget a plan that needs more expansions than one step
+// allows goes on in the next steps and the mouse waits in its cell.
+typedef struct {
+    PlanStage stage;
+    bool started;   // planner_begin ran for this stage
+    bool open;      // ... and the start can reach the goal
+    int budget;     // Expansions left in this step
+    int steps;      // solver_steps the plan has taken so far
+    uint32_t known_cost, optimistic_cost; // Results, PLAN_NO_PATH if none or not planned
+} PlanJob;
+
+// Next search step planned while the mouse drives into `cell`. The arrival can
+// only reveal walls, and the candidates differ in the one most likely to
+// appear: the segment straight ahead. The decision is used only if the map then
+// differs from the one it was made on by nothing or by exactly that segment.
+typedef struct {
+    bool ready;             // Candidates below are for arriving in cell
+    bool has_walled;        // walled_dir and walled are valid (the segment was unsensed)
+    CellIndex cell;
+    Direction side;         // Segment the candidates differ in
+    int field;              // FieldSlot the candidates were computed in
+    uint16_t wall_version;  // Maze.wall_version they were computed on
+    Direction open_dir;     // Next direction if no new wall is sensed
+    Direction walled_dir;   // Next direction if only the segment ahead turns out walled
+    DistanceField walled;   // The field with that segment set
+    bool have_choice;       // choice holds this step's direction
+    Direction choice;
+    int hits, arrivals;     // Speculated arrivals, and those decided ahead
+    bool ahead_sensed;      // ahead_cell's walls came in from walls_ahead during the move
+    CellIndex ahead_cell;
+    int early_readings;     // Arrivals sensed that way
+} Speculation;
+
+// Tunable search heuristics. Every Solver has its own, so parameter sweeps
+// can run many solvers side by side with different settings.
+typedef struct {
+    int explore_bonus; // Subtracted from an unvisited neighbour's distance in SEARCH_MODE
+    // Exploration after the first goal arrival goes on only while the optimistic
+    // path is more than this many ms faster than the known-open one; at or below
+    // it the speed run takes the known path and the unverified segments are left
+    uint32_t min_verify_saving;
+    // Planner state expansions per solver_step, 0 for no limit. Bounds the work
+    // of the steps that plan the speed run; a plan that needs more is spread over
+    // several steps and returns the same path
+    int plan_budget;
+} SolverParams;
+
+// What plan_exploration decided
+typedef enum {
+    EXPLORE_DONE,    // The bounds are close enough, explore no more
+    EXPLORE_TARGETS, // Distances now lead to the cells that can shorten the run
+    EXPLORE_PENDING  // Out of plan budget for this step, call again in the next one
+} ExploreResult;
+
+// Everything one solver instance needs
+typedef struct {
+    Maze maze;
+    MouseState mouse;
+    PathPlanner planner;
+    const MouseIO *io;
+    Trace *trace; // Optional event trace, NULL when not recording
+    MapPolicy map_policy;      // Applied by every solver_reset
+    uint16_t saved_wall_version; // Maze.wall_version at the last save_map
+    Speculation speculation;     // Used when the backend has start_forward / finish_forward
+    SolverParams params;         // Applied by every solver_reset
+    PlanJob plan;                // Cleared by every solver_reset
+    bool has_goal;               // goal replaces the backend's goal cells on every reset
+    MazeRow goal[MAZE_MAX_HEIGHT];
+} Solver;
+
+// Receives the solver's log messages (NULL drops them, the default)
+typedef void (*SolverLogFn)(const char *msg);
+
+extern const Point direction_delta[DIRECTION_COUNT];
+
+// --- Solver Lifecycle ---
+bool solver_init(Solver *s, const MouseIO *io);
+bool solver_reset(Solver *s);
+bool solver_step(Solver *s);
+void solver_run(Solver *s);
+void solver_set_log(SolverLogFn fn);
+void solver_set_trace(Solver *s, Trace *trace);
+bool solver_set_goal(Solver *s, const MazeRow *cells);
+SolverParams solver_default_params(void);
+void solver_set_params(Solver *s, const SolverParams *params);
+bool solver_load_map(Solver *s, MapPolicy policy);
+bool solver_save_map(Solver *s);
+
+// --- Maze Knowledge ---
+bool init_maze(Maze *m, int width, int height);
+void init_mouse(MouseState *ms, Maze *m);
+
+bool is_within_bounds(const Maze *m, Point p);
+bool is_at_goal(const Maze *m, Point p);
+bool set_goal_cells(Maze *m, const MazeRow *cells);
+bool is_at_start(Point p);
+Direction get_opposite_direction(Direction dir);
+
+bool is_visited(const Maze *m, Point p);
+void set_visited(Maze *m, Point p);
+
+bool set_wall(Maze *m, Point p, Direction dir);
+bool has_wall(const Maze *m, Point p, Direction dir); // Walls found so far, false for unsensed sides
+WallState wall_state(const Maze *m, Point p, Direction dir);
+
+// --- Flood Fill ---
+void push_repair(Maze *m, CellIndex c);
+bool is_flood_target(const Maze *m, const DistanceField *f, CellIndex c);
+bool flood_fill_repair(Maze *m, DistanceField *f);
+void reset_repair_stack(Maze *m);
+void flood_fill(Maze *m, Point target);
+void flood_fill_goal(Maze *m);
+void flood_fill_start(Maze *m);
+void flood_fill_cells(Maze *m, const MazeRow *cells);
+
+// Full rebuild engines behind the fills above: both set the seeds to 0 and give
+// every other cell its BFS distance. The fills use the queue BFS unless built
+// with -DSOLVER_FLOOD_WAVEFRONT (bit-parallel, one row word per cell row).
+void flood_fill_queue(Maze *m, DistanceField *f, const MazeRow *seeds);
+void flood_fill_wavefront(Maze *m, DistanceField *f, const MazeRow *seeds);
+
+// --- Planning ---
+Direction choose_next_direction(const MouseState *ms, const Maze *m);
+uint32_t compute_shortest_path(MouseState *ms, Maze *m, PathPlanner *pp, bool known_only);
+// compute_shortest_path in pieces: begin, expand until it returns true, finish
+bool planner_begin(Maze *m, PathPlanner *pp, bool known_only);
+bool planner_expand(PathPlanner *pp, const Maze *m, int *budget);
+uint32_t planner_finish(MouseState *ms, PathPlanner *pp);
+ExploreResult plan_exploration(Solver *s);
+void compile_moves(MouseState *ms, bool diagonals);
+bool verify_path_exploration(const MouseState *ms, const Maze *m);
+
+// --- Backend-Driven Actions ---
+void update_walls_current_cell(Solver *s);
+void turn_to_direction(Solver *s, Direction target_dir);
+void move_forward_update_state(Solver *s);
+void follow_shortest_path(Solver *s);
+void update_display(const Solver *s);
+void solver_flood_fill(Solver *s, Point target);
+void solver_flood_fill_goal(Solver *s);
+void solver_flood_fill_start(Solver *s);
+void solver_flood_fill_cells(Solver *s, const MazeRow *cells);
+
+void log_message(const char *msg);
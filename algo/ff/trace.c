@@ -0,0 +1,22 @@
+#include "trace.h"
+#include <string.h>
+
+void trace_init(Trace *t) {
+    memset(t, 0, sizeof(*t));
+}
+
+// Copies up to max unread records. A reader that fell more than a whole ring
+// behind skips to the oldest record still there and counts the rest as dropped.
+int trace_read(Trace *t, TraceEvent *out, int max) {
+    if (t->head - t->tail > TRACE_CAPACITY) {
+        t->dropped += t->head - t->tail - TRACE_CAPACITY;
+        t->tail = t->head - TRACE_CAPACITY;
+    }
+
+    int count = 0;
+    while (count < max && t->tail != t->head) {
+        out[count++] = t->events[t->tail & (TRACE_CAPACITY - 1)];
+        t->tail++;
+    }
+    return count;
+}
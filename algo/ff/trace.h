@@ -0,0 +1,73 @@
+#pragma once
+#include <stdint.h>
+
+// trace.h
+// Binary event trace of a solver run. Every event is one fixed-size record
+// written into a ring buffer, so recording costs the same few stores no
+// matter what happened, and nothing blocks: when the reader falls behind
+// the oldest records are overwritten and counted as dropped.
+// The producer is the solver's step loop; drain it from the same context
+// (after each solver_step) or from a lower priority task on the target.
+// tools/tracedump.c turns a saved trace back into text or JSON.
+
+// Ring size in records, a power of two
+#ifndef TRACE_CAPACITY
+#define TRACE_CAPACITY 1024
+#endif
+#if (TRACE_CAPACITY & (TRACE_CAPACITY - 1)) != 0
+#error "TRACE_CAPACITY must be a power of two"
+#endif
+
+typedef enum {
+    TRACE_INIT = 1, // Maze size: x = width, y = height
+    TRACE_STEP,     // End of a step at (x,y): arg = heading, value = cells touched by fills this step
+    TRACE_MODE,     // Mode change at (x,y): arg = new RunMode
+    TRACE_WALL,     // New wall on side arg of (x,y)
+    TRACE_MOVE,     // Arrived at (x,y) heading arg after value cells
+    TRACE_TURN,     // In place at (x,y), now heading arg after value quarter turns clockwise
+    TRACE_CRASH,    // Move from (x,y) heading arg stopped by a wall
+    TRACE_FLOOD,    // Fill done at (x,y): arg = FieldSlot, value = cells touched
+    TRACE_PLAN,     // Speed run planned: arg = moves, value = estimated cost (ms)
+    TRACE_KIND_COUNT
+} TraceKind;
+
+// One record, 8 bytes, little-endian on every target we build for
+typedef struct {
+    uint8_t kind;   // TraceKind
+    uint8_t x;      // Cell the event happened in
+    uint8_t y;
+    uint8_t arg;    // Direction, mode or field slot, see TraceKind
+    uint32_t value; // Count or cost, see TraceKind
+} TraceEvent;
+
+typedef struct {
+    TraceEvent events[TRACE_CAPACITY];
+    uint32_t head;    // Records written since trace_init
+    uint32_t tail;    // Records read since trace_init
+    uint32_t dropped; // Records overwritten before they were read
+} Trace;
+
+// Saved traces: this header, then the records in order
+#define TRACE_FILE_MAGIC "FFTR"
+#define TRACE_FILE_VERSION 1
+
+typedef struct {
+    char magic[4];        // TRACE_FILE_MAGIC
+    uint16_t version;     // TRACE_FILE_VERSION
+    uint16_t record_size; // sizeof(TraceEvent)
+} TraceFileHeader;
+
+void trace_init(Trace *t);
+int trace_read(Trace *t, TraceEvent *out, int max); // Oldest first, returns the count copied
+
+// Appends one record, a no-op without a trace
+static inline void trace_record(Trace *t, TraceKind kind, int x, int y, int arg, uint32_t value) {
+    if (t == 0) return;
+    TraceEvent *e = &t->events[t->head & (TRACE_CAPACITY - 1)];
+    e->kind = (uint8_t)kind;
+    e->x = (uint8_t)x;
+    e->y = (uint8_t)y;
+    e->arg = (uint8_t)arg;
+    e->value = value;
+    t->head++;
+}
@@ -0,0 +1,456 @@
+/// ffbench.c
+/// runs flood-fill variants built against the headless backend over a
+/// directory of maze files or a maze corpus packed by ffpack.c, one process
+/// per core, and collects the per-run metrics the backend writes to
+/// SIM_STATS_FILE. with a corpus every run maps the same file and unpacks
+/// its one maze (SIM_MAZE_ID), nothing is parsed.
+///
+///   (cd ../algo/ff && gcc -O2 ffv3.c solver.c grid.c trace.c map_image.c record.c io_api.c display.c api_sim.c sim.c corpus.c -o ffv3.out)
+///   gcc -O2 ffbench.c ../algo/ff/{corpus,sim}.c -o ffbench
+///   ./ffbench -f csv -o results.csv mazes/ ../algo/ff/ffv2.out ../algo/ff/ffv3.out
+///   ./ffbench mazes.ffmz ../algo/ff/ffv3.out
+///
+/// with -r oracle.csv (written by fforacle.c) every row also gets the maze's
+/// optimal speed run, a lower bound on its exploration and the run's regret
+/// against both.
+///
+/// every (algorithm, maze) pair is one row. runs that exit with an error
+/// or a signal are kept with their status so broken variants stay visible.
+
+#define _POSIX_C_SOURCE 200809L
+#include "../algo/ff/corpus.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define MAX_PATH_LENGTH 1024
+#define MAX_STATS_LINE 512
+#define MAX_METRICS 16
+
+// keys written by sim_write_stats in sim.c, in output column order
+static const char *const metric_names[MAX_METRICS] = {
+    "reached_goal", "search_cells", "search_turns", "return_cells",
+    "return_turns", "explore_cells", "speed_cells", "speed_turns",
+    "moves",        "turns",        "crashes",      "flood_fill_ms",
+    "cpu_ms",       NULL};
+
+#define ORACLE_COLUMNS 7
+
+// columns joined from the oracle file, in output order
+static const char *const oracle_names[ORACLE_COLUMNS] = {
+    "optimal_cells", "optimal_turns", "optimal_cost_ms",     "explore_bound_cells",
+    "regret_cells",  "regret_turns",  "explore_regret_cells"};
+
+typedef enum { FORMAT_CSV, FORMAT_JSON } OutputFormat;
+
+// one row of fforacle output
+typedef struct {
+    char maze[MAX_PATH_LENGTH]; // basename, so oracles from another directory still join
+    long optimal_cells, optimal_turns, optimal_cost_ms;
+    long explore_bound_cells;
+} OracleRow;
+
+typedef struct {
+    const char *algorithm; // path to the headless binary
+    char maze[MAX_PATH_LENGTH]; // file path, or the maze's name in the corpus
+    long maze_id;               // corpus record, -1 for a maze file
+    pid_t pid;
+    int exit_code;  // -1 until the run finished
+    int signal;     // terminating signal, 0 if it exited normally
+    bool has_stats; // SIM_STATS_FILE was written
+    char metrics[MAX_METRICS][32];
+    char oracle[ORACLE_COLUMNS][32]; // empty unless the maze is in the oracle file
+} Run;
+
+typedef struct {
+    int jobs;
+    OutputFormat format;
+    const char *output;
+    const char *log_dir; // keep each run's stderr here if set
+    const char *oracle;  // fforacle csv to join, if set
+    const char *corpus;  // the maze argument, if it is a corpus
+    char stats_dir[64];  // private temp dir for the SIM_STATS_FILE outputs
+} Options;
+
+// --- Maze Discovery ---
+
+static bool is_maze_file(const char *name) {
+    const char *ext = strrchr(name, '.');
+    return ext && (strcmp(ext, ".num") == 0 || strcmp(ext, ".map") == 0);
+}
+
+static int compare_strings(const void *a, const void *b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+// Returns a sorted list of maze file paths in dir, NULL on error
+static char **list_mazes(const char *dir, int *count) {
+    DIR *d = opendir(dir);
+    if (!d) {
+        perror(dir);
+        return NULL;
+    }
+
+    int capacity = 64;
+    char **mazes = malloc(capacity * sizeof(char *));
+    *count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (!is_maze_file(entry->d_name)) continue;
+        if (*count == capacity) {
+            capacity *= 2;
+            mazes = realloc(mazes, capacity * sizeof(char *));
+        }
+        char path[MAX_PATH_LENGTH];
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        mazes[(*count)++] = strdup(path);
+    }
+    closedir(d);
+    qsort(mazes, *count, sizeof(char *), compare_strings);
+    return mazes;
+}
+
+// Names of the mazes in a corpus, in id order. NULL on error
+static char **list_corpus(const char *path, int *count) {
+    Corpus corpus;
+    if (!corpus_open(&corpus, path)) return NULL;
+    char **mazes = malloc((corpus.count > 0 ? corpus.count : 1) * sizeof(char *));
+    for (uint32_t i = 0; i < corpus.count; i++) mazes[i] = strndup(corpus.mazes[i].name, CORPUS_NAME_SIZE - 1);
+    *count = (int)corpus.count;
+    corpus_close(&corpus);
+    return mazes;
+}
+
+// --- Running ---
+
+static void stats_path(const Options *opt, int index, char *out, size_t size) {
+    snprintf(out, size, "%s/%d.stats", opt->stats_dir, index);
+}
+
+static void log_path(const Options *opt, const Run *run, char *out, size_t size) {
+    char algorithm[MAX_PATH_LENGTH], maze[MAX_PATH_LENGTH];
+    snprintf(algorithm, sizeof(algorithm), "%s", run->algorithm);
+    snprintf(maze, sizeof(maze), "%s", run->maze);
+    snprintf(out, size, "%s/%s.%s.log", opt->log_dir, basename(algorithm), basename(maze));
+}
+
+// Forks and execs one headless run, returns the child pid
+static pid_t start_run(const Options *opt, Run *run, int index) {
+    char stats[MAX_PATH_LENGTH];
+    stats_path(opt, index, stats, sizeof(stats));
+
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+
+    if (run->maze_id >= 0) {
+        char id[32];
+        snprintf(id, sizeof(id), "%ld", run->maze_id);
+        setenv("SIM_MAZE_FILE", opt->corpus, 1);
+        setenv("SIM_MAZE_ID", id, 1);
+    } else {
+        setenv("SIM_MAZE_FILE", run->maze, 1);
+    }
+    setenv("SIM_STATS_FILE", stats, 1);
+
+    int null_fd = open("/dev/null", O_RDWR);
+    int err_fd = null_fd;
+    if (opt->log_dir) {
+        char log[MAX_PATH_LENGTH];
+        log_path(opt, run, log, sizeof(log));
+        err_fd = open(log, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (err_fd < 0) err_fd = null_fd;
+    }
+    dup2(null_fd, STDIN_FILENO);
+    dup2(null_fd, STDOUT_FILENO);
+    dup2(err_fd, STDERR_FILENO);
+
+    execl(run->algorithm, run->algorithm, (char *)NULL);
+    _exit(127);
+}
+
+// Reads the key=value line written by the headless backend
+static void read_stats(const Options *opt, Run *run, int index) {
+    char path[MAX_PATH_LENGTH];
+    stats_path(opt, index, path, sizeof(path));
+    FILE *file = fopen(path, "r");
+    if (!file) return;
+
+    char line[MAX_STATS_LINE];
+    if (fgets(line, sizeof(line), file)) {
+        run->has_stats = true;
+        for (char *token = strtok(line, " \n"); token; token = strtok(NULL, " \n")) {
+            char *eq = strchr(token, '=');
+            if (!eq) continue;
+            *eq = '\0';
+            for (int i = 0; metric_names[i]; i++) {
+                if (strcmp(token, metric_names[i]) == 0) {
+                    snprintf(run->metrics[i], sizeof(run->metrics[i]), "%s", eq + 1);
+                }
+            }
+        }
+    }
+    fclose(file);
+    unlink(path);
+}
+
+// Keeps up to opt->jobs children running until every run has finished
+static void run_all(const Options *opt, Run *runs, int run_count) {
+    int next = 0, running = 0, done = 0;
+    bool progress = isatty(STDERR_FILENO);
+
+    while (done < run_count) {
+        while (running < opt->jobs && next < run_count) {
+            runs[next].pid = start_run(opt, &runs[next], next);
+            if (runs[next].pid < 0) {
+                perror("fork");
+                exit(1);
+            }
+            next++;
+            running++;
+        }
+
+        int status;
+        pid_t pid = wait(&status);
+        if (pid < 0) {
+            perror("wait");
+            exit(1);
+        }
+        for (int i = 0; i < next; i++) {
+            if (runs[i].pid != pid) continue;
+            runs[i].exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 128;
+            runs[i].signal = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+            read_stats(opt, &runs[i], i);
+            break;
+        }
+        running--;
+        done++;
+        if (progress) fprintf(stderr, "\rffbench: %d/%d runs", done, run_count);
+    }
+    if (progress) fprintf(stderr, "\n");
+}
+
+// --- Oracle Join ---
+
+static int metric_index(const char *name) {
+    for (int i = 0; metric_names[i]; i++) {
+        if (strcmp(metric_names[i], name) == 0) return i;
+    }
+    return -1;
+}
+
+// Reads the ok rows of an fforacle csv, NULL on error
+static OracleRow *read_oracle(const char *path, int *count) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return NULL;
+    }
+
+    int capacity = 64;
+    OracleRow *rows = malloc(capacity * sizeof(OracleRow));
+    *count = 0;
+    char line[MAX_PATH_LENGTH + 128];
+    while (fgets(line, sizeof(line), file)) {
+        char maze[MAX_PATH_LENGTH], status[32];
+        OracleRow row;
+        int width, height;
+        if (sscanf(line, "%1023[^,],%31[^,],%d,%d,%ld,%ld,%ld,%*d,%ld", maze, status, &width, &height,
+                   &row.optimal_cells, &row.optimal_turns, &row.optimal_cost_ms, &row.explore_bound_cells) != 8 ||
+            strcmp(status, "ok") != 0) {
+            continue; // header, or a maze the oracle could not solve
+        }
+        snprintf(row.maze, sizeof(row.maze), "%s", basename(maze));
+        if (*count == capacity) {
+            capacity *= 2;
+            rows = realloc(rows, capacity * sizeof(OracleRow));
+        }
+        rows[(*count)++] = row;
+    }
+    fclose(file);
+    return rows;
+}
+
+// Fills each run's oracle columns; regret only for runs that made a speed run
+static void join_oracle(Run *runs, int run_count, const OracleRow *rows, int row_count) {
+    int speed_cells = metric_index("speed_cells"), speed_turns = metric_index("speed_turns");
+    int explore_cells = metric_index("explore_cells");
+    for (int r = 0; r < run_count; r++) {
+        Run *run = &runs[r];
+        char maze[MAX_PATH_LENGTH];
+        snprintf(maze, sizeof(maze), "%s", run->maze);
+        const char *name = basename(maze);
+
+        for (int i = 0; i < row_count; i++) {
+            if (strcmp(rows[i].maze, name) != 0) continue;
+            snprintf(run->oracle[0], sizeof(run->oracle[0]), "%ld", rows[i].optimal_cells);
+            snprintf(run->oracle[1], sizeof(run->oracle[1]), "%ld", rows[i].optimal_turns);
+            snprintf(run->oracle[2], sizeof(run->oracle[2]), "%ld", rows[i].optimal_cost_ms);
+            snprintf(run->oracle[3], sizeof(run->oracle[3]), "%ld", rows[i].explore_bound_cells);
+            long cells = atol(run->metrics[speed_cells]);
+            if (run->has_stats && cells > 0) {
+                snprintf(run->oracle[4], sizeof(run->oracle[4]), "%ld", cells - rows[i].optimal_cells);
+                snprintf(run->oracle[5], sizeof(run->oracle[5]), "%ld",
+                         atol(run->metrics[speed_turns]) - rows[i].optimal_turns);
+                snprintf(run->oracle[6], sizeof(run->oracle[6]), "%ld",
+                         atol(run->metrics[explore_cells]) - rows[i].explore_bound_cells);
+            }
+            break;
+        }
+    }
+}
+
+// --- Output ---
+
+static const char *run_status(const Run *run) {
+    if (run->signal) return "signal";
+    if (run->exit_code == 127) return "exec_failed";
+    if (run->exit_code == 3) return "step_limit";
+    if (run->exit_code != 0) return "error";
+    return run->has_stats ? "ok" : "no_stats";
+}
+
+static void json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+static void write_results(FILE *out, OutputFormat format, const Run *runs, int run_count, bool oracle) {
+    int oracle_columns = oracle ? ORACLE_COLUMNS : 0;
+    if (format == FORMAT_CSV) {
+        fprintf(out, "algorithm,maze,status,exit_code");
+        for (int i = 0; metric_names[i]; i++) fprintf(out, ",%s", metric_names[i]);
+        for (int i = 0; i < oracle_columns; i++) fprintf(out, ",%s", oracle_names[i]);
+        fprintf(out, "\n");
+        for (int r = 0; r < run_count; r++) {
+            const Run *run = &runs[r];
+            fprintf(out, "%s,%s,%s,%d", run->algorithm, run->maze, run_status(run), run->exit_code);
+            for (int i = 0; metric_names[i]; i++) fprintf(out, ",%s", run->metrics[i]);
+            for (int i = 0; i < oracle_columns; i++) fprintf(out, ",%s", run->oracle[i]);
+            fprintf(out, "\n");
+        }
+        return;
+    }
+
+    fprintf(out, "[\n");
+    for (int r = 0; r < run_count; r++) {
+        const Run *run = &runs[r];
+        fprintf(out, "  {\"algorithm\": ");
+        json_string(out, run->algorithm);
+        fprintf(out, ", \"maze\": ");
+        json_string(out, run->maze);
+        fprintf(out, ", \"status\": \"%s\", \"exit_code\": %d", run_status(run), run->exit_code);
+        for (int i = 0; metric_names[i]; i++) {
+            fprintf(out, ", \"%s\": %s", metric_names[i], run->metrics[i][0] ? run->metrics[i] : "null");
+        }
+        for (int i = 0; i < oracle_columns; i++) {
+            fprintf(out, ", \"%s\": %s", oracle_names[i], run->oracle[i][0] ? run->oracle[i] : "null");
+        }
+        fprintf(out, "}%s\n", r + 1 < run_count ? "," : "");
+    }
+    fprintf(out, "]\n");
+}
+
+// --- Main ---
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-j jobs] [-f csv|json] [-o output] [-l log_dir] [-r oracle.csv] maze_dir|corpus algorithm...\n"
+            "  algorithm  binary linked against api_sim.c\n"
+            "  -j         parallel runs (default: number of online cores)\n"
+            "  -f         output format (default: csv)\n"
+            "  -o         output file (default: stdout)\n"
+            "  -l         keep each run's stderr log in this directory\n"
+            "  -r         join optimal paths from an fforacle csv and report regret\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    Options opt = {0};
+    opt.jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (opt.jobs < 1) opt.jobs = 1;
+    opt.format = FORMAT_CSV;
+
+    int c;
+    while ((c = getopt(argc, argv, "j:f:o:l:r:h")) != -1) {
+        switch (c) {
+            case 'j': opt.jobs = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+            case 'f':
+                if (strcmp(optarg, "json") == 0) {
+                    opt.format = FORMAT_JSON;
+                } else if (strcmp(optarg, "csv") != 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'o': opt.output = optarg; break;
+            case 'l': opt.log_dir = optarg; break;
+            case 'r': opt.oracle = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (argc - optind < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    OracleRow *oracle_rows = NULL;
+    int oracle_count = 0;
+    if (opt.oracle && !(oracle_rows = read_oracle(opt.oracle, &oracle_count))) return 1;
+
+    int maze_count;
+    if (corpus_is_file(argv[optind])) opt.corpus = argv[optind];
+    char **mazes = opt.corpus ? list_corpus(opt.corpus, &maze_count) : list_mazes(argv[optind], &maze_count);
+    if (!mazes) return 1;
+    if (maze_count == 0) {
+        fprintf(stderr, "ffbench: no mazes in %s\n", argv[optind]);
+        return 1;
+    }
+
+    int algorithm_count = argc - optind - 1;
+    int run_count = maze_count * algorithm_count;
+    Run *runs = calloc(run_count, sizeof(Run));
+    for (int a = 0; a < algorithm_count; a++) {
+        for (int m = 0; m < maze_count; m++) {
+            Run *run = &runs[a * maze_count + m];
+            run->algorithm = argv[optind + 1 + a];
+            snprintf(run->maze, sizeof(run->maze), "%s", mazes[m]);
+            run->maze_id = opt.corpus ? m : -1;
+            run->exit_code = -1;
+        }
+    }
+
+    snprintf(opt.stats_dir, sizeof(opt.stats_dir), "/tmp/ffbench.XXXXXX");
+    if (!mkdtemp(opt.stats_dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    run_all(&opt, runs, run_count);
+    rmdir(opt.stats_dir);
+    if (oracle_rows) join_oracle(runs, run_count, oracle_rows, oracle_count);
+
+    FILE *out = opt.output ? fopen(opt.output, "w") : stdout;
+    if (!out) {
+        perror(opt.output);
+        return 1;
+    }
+    write_results(out, opt.format, runs, run_count, opt.oracle != NULL);
+    if (out != stdout) fclose(out);
+
+    for (int m = 0; m < maze_count; m++) free(mazes[m]);
+    free(mazes);
+    free(runs);
+    free(oracle_rows);
+    return 0;
+}
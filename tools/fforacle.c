@@ -0,0 +1,283 @@
+/// fforacle.c
+/// offline optimum for every maze in a directory or a maze corpus packed by
+/// ffpack.c: runs the ffv3 speed run planner (compute_shortest_path in
+/// solver.c) on the complete wall map, so a search strategy can be scored
+/// against what a mouse that already knew the maze would do. one worker
+/// thread per core, each with its own solver state.
+///
+/// explore_bound_cells is a lower bound on the exploration before the speed
+/// run, not the minimum: the search run and the return trip each cover at
+/// least the fewest cells between start and goal.
+///
+///   gcc -O2 -pthread fforacle.c ../algo/ff/{corpus,solver,grid,trace,map_image,sim}.c -o fforacle
+///   ./fforacle -o oracle.csv mazes/
+///   ./fforacle -o oracle.csv mazes.ffmz
+///   ./ffbench -r oracle.csv mazes/ ../algo/ff/ffv3.out   # adds optimum and regret columns
+///
+/// add -DMAZE_MAX_SIZE=32 to the solver build for half-size mazes.
+
+#define _POSIX_C_SOURCE 200809L
+#include "../algo/ff/corpus.h"
+#include "../algo/ff/solver.h"
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_PATH_LENGTH 1024
+
+typedef enum { FORMAT_CSV, FORMAT_JSON } OutputFormat;
+
+typedef struct {
+    char maze[MAX_PATH_LENGTH]; // file path, or the maze's name in the corpus
+    long maze_id;               // corpus record, -1 for a maze file
+    const char *status; // "ok", "load_failed", "too_large" or "no_path"
+    int width, height;
+    int optimal_cells;       // Speed run path found by the planner
+    int optimal_turns;       // Quarter turns on it after leaving the start cell, 180s count twice like sim.c
+    uint32_t optimal_cost;   // Planner cost estimate (ms)
+    int shortest_cells;      // Fewest cells from start to goal, ignoring turns
+    int explore_bound_cells; // Search run and return trip of shortest_cells each
+} Result;
+
+typedef struct {
+    const Corpus *corpus; // NULL for a maze directory
+    Result *results;
+    int count;
+    int next; // Next maze to solve, shared by the workers
+    pthread_mutex_t lock;
+} WorkQueue;
+
+// Per-thread solver state, too large for a thread's stack
+typedef struct {
+    Maze maze;
+    MouseState mouse;
+    PathPlanner planner;
+} Oracle;
+
+// --- Maze Discovery ---
+
+static bool is_maze_file(const char *name) {
+    const char *ext = strrchr(name, '.');
+    return ext && (strcmp(ext, ".num") == 0 || strcmp(ext, ".map") == 0);
+}
+
+static int compare_results(const void *a, const void *b) {
+    return strcmp(((const Result *)a)->maze, ((const Result *)b)->maze);
+}
+
+// Returns the sorted maze files in dir as unsolved results, NULL on error
+static Result *list_mazes(const char *dir, int *count) {
+    DIR *d = opendir(dir);
+    if (!d) {
+        perror(dir);
+        return NULL;
+    }
+
+    int capacity = 64;
+    Result *results = malloc(capacity * sizeof(Result));
+    *count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (!is_maze_file(entry->d_name)) continue;
+        if (*count == capacity) {
+            capacity *= 2;
+            results = realloc(results, capacity * sizeof(Result));
+        }
+        Result *r = &results[(*count)++];
+        memset(r, 0, sizeof(*r));
+        snprintf(r->maze, sizeof(r->maze), "%s/%s", dir, entry->d_name);
+        r->maze_id = -1;
+    }
+    closedir(d);
+    qsort(results, *count, sizeof(Result), compare_results);
+    return results;
+}
+
+// The mazes of a corpus as unsolved results, in id order
+static Result *list_corpus(const Corpus *corpus, int *count) {
+    Result *results = calloc(corpus->count > 0 ? corpus->count : 1, sizeof(Result));
+    for (uint32_t i = 0; i < corpus->count; i++) {
+        snprintf(results[i].maze, sizeof(results[i].maze), "%.*s", CORPUS_NAME_SIZE - 1, corpus->mazes[i].name);
+        results[i].maze_id = (long)i;
+    }
+    *count = (int)corpus->count;
+    return results;
+}
+
+// --- Solving ---
+
+// Plans on the full map: every wall set, every cell visited, so the
+// known-only planner sees exactly the real maze
+static void solve(Oracle *o, const Corpus *corpus, Result *r) {
+    Sim sim;
+    bool loaded = r->maze_id >= 0 ? corpus_sim(&corpus->mazes[r->maze_id], &sim) : sim_load_file(&sim, r->maze);
+    if (!loaded) {
+        r->status = "load_failed";
+        return;
+    }
+    r->width = sim.width;
+    r->height = sim.height;
+    if (!init_maze(&o->maze, sim.width, sim.height)) {
+        r->status = "too_large";
+        return;
+    }
+
+    for (int x = 0; x < sim.width; x++) {
+        for (int y = 0; y < sim.height; y++) {
+            for (Direction dir = 0; dir < DIRECTION_COUNT; dir++) {
+                if ((sim.walls[x][y] >> dir) & 1) set_wall(&o->maze, (Point){x, y}, dir);
+            }
+            set_visited(&o->maze, (Point){x, y});
+        }
+    }
+
+    o->planner.diagonals = false;
+    r->optimal_cost = compute_shortest_path(&o->mouse, &o->maze, &o->planner, true);
+    if (r->optimal_cost == PLAN_NO_PATH) {
+        r->status = "no_path";
+        return;
+    }
+    r->optimal_cells = o->mouse.path_length - 1;
+    // sim.c starts the speed run on the first move out of the start cell,
+    // so turns in place before it count on neither side
+    int first = 0;
+    while (first < o->mouse.move_count && o->mouse.moves[first].kind >= MOVE_RIGHT &&
+           o->mouse.moves[first].kind <= MOVE_AROUND) {
+        first++;
+    }
+    for (int i = first; i < o->mouse.move_count; i++) {
+        uint8_t kind = o->mouse.moves[i].kind;
+        if (kind == MOVE_RIGHT || kind == MOVE_LEFT) r->optimal_turns++;
+        if (kind == MOVE_AROUND) r->optimal_turns += 2;
+    }
+    r->shortest_cells = o->maze.fields[FIELD_GOAL].distances[grid_index((Point){0, 0})];
+    r->explore_bound_cells = 2 * r->shortest_cells;
+    r->status = "ok";
+}
+
+static void *worker(void *arg) {
+    WorkQueue *queue = arg;
+    Oracle *oracle = malloc(sizeof(Oracle));
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+        int index = queue->next++;
+        pthread_mutex_unlock(&queue->lock);
+        if (index >= queue->count) break;
+        solve(oracle, queue->corpus, &queue->results[index]);
+    }
+    free(oracle);
+    return NULL;
+}
+
+// --- Output ---
+
+static void json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+static void write_results(FILE *out, OutputFormat format, const Result *results, int count) {
+    if (format == FORMAT_CSV) {
+        fprintf(out, "maze,status,width,height,optimal_cells,optimal_turns,optimal_cost_ms,shortest_cells,"
+                     "explore_bound_cells\n");
+        for (int i = 0; i < count; i++) {
+            const Result *r = &results[i];
+            fprintf(out, "%s,%s,%d,%d,%d,%d,%lu,%d,%d\n", r->maze, r->status, r->width, r->height, r->optimal_cells,
+                    r->optimal_turns, (unsigned long)(r->optimal_cost == PLAN_NO_PATH ? 0 : r->optimal_cost),
+                    r->shortest_cells, r->explore_bound_cells);
+        }
+        return;
+    }
+
+    fprintf(out, "[\n");
+    for (int i = 0; i < count; i++) {
+        const Result *r = &results[i];
+        fprintf(out, "  {\"maze\": ");
+        json_string(out, r->maze);
+        fprintf(out,
+                ", \"status\": \"%s\", \"width\": %d, \"height\": %d, \"optimal_cells\": %d, "
+                "\"optimal_turns\": %d, \"optimal_cost_ms\": %lu, \"shortest_cells\": %d, "
+                "\"explore_bound_cells\": %d}%s\n",
+                r->status, r->width, r->height, r->optimal_cells, r->optimal_turns,
+                (unsigned long)(r->optimal_cost == PLAN_NO_PATH ? 0 : r->optimal_cost), r->shortest_cells,
+                r->explore_bound_cells, i + 1 < count ? "," : "");
+    }
+    fprintf(out, "]\n");
+}
+
+// --- Main ---
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-j jobs] [-f csv|json] [-o output] maze_dir|corpus\n"
+            "  -j  worker threads (default: number of online cores)\n"
+            "  -f  output format (default: csv)\n"
+            "  -o  output file (default: stdout)\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    OutputFormat format = FORMAT_CSV;
+    const char *output = NULL;
+
+    int c;
+    while ((c = getopt(argc, argv, "j:f:o:h")) != -1) {
+        switch (c) {
+            case 'j': jobs = atoi(optarg); break;
+            case 'f':
+                if (strcmp(optarg, "json") == 0) {
+                    format = FORMAT_JSON;
+                } else if (strcmp(optarg, "csv") != 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'o': output = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (jobs < 1) jobs = 1;
+    if (argc - optind != 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    WorkQueue queue = {0};
+    Corpus corpus = {0};
+    if (corpus_is_file(argv[optind])) {
+        if (!corpus_open(&corpus, argv[optind])) return 1;
+        queue.corpus = &corpus;
+        queue.results = list_corpus(&corpus, &queue.count);
+    } else {
+        queue.results = list_mazes(argv[optind], &queue.count);
+    }
+    if (!queue.results) return 1;
+    pthread_mutex_init(&queue.lock, NULL);
+
+    if (jobs > queue.count) jobs = queue.count > 0 ? queue.count : 1;
+    pthread_t *threads = malloc(jobs * sizeof(pthread_t));
+    for (int i = 0; i < jobs; i++) pthread_create(&threads[i], NULL, worker, &queue);
+    for (int i = 0; i < jobs; i++) pthread_join(threads[i], NULL);
+
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        perror(output);
+        return 1;
+    }
+    write_results(out, format, queue.results, queue.count);
+    if (out != stdout) fclose(out);
+
+    pthread_mutex_destroy(&queue.lock);
+    free(threads);
+    free(queue.results);
+    corpus_close(&corpus);
+    return 0;
+}
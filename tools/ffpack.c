@@ -0,0 +1,185 @@
+/// ffpack.c
+/// packs a directory of mms maze files (.num, .map) into one maze corpus
+/// (algo/ff/corpus.h): fixed-size records of packed walls, goal mask and name
+/// that ffsweep and ffbench map read-only instead of parsing every file.
+/// maze ids follow the sorted file names, the same order the tools use for
+/// a directory. -l prints a corpus's index.
+///
+///   gcc -O2 ffpack.c ../algo/ff/{corpus,sim}.c -o ffpack
+///   ./ffpack -o mazes.ffmz mazes/
+///   ./ffpack -l mazes.ffmz
+///   ./ffsweep -e 0:4 mazes.ffmz
+
+#define _POSIX_C_SOURCE 200809L
+#include "../algo/ff/corpus.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_PATH_LENGTH 1024
+
+typedef enum { FORMAT_CSV, FORMAT_JSON } OutputFormat;
+
+// --- Maze Discovery ---
+
+static bool is_maze_file(const char *name) {
+    const char *ext = strrchr(name, '.');
+    return ext && (strcmp(ext, ".num") == 0 || strcmp(ext, ".map") == 0);
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Packs every maze file in dir, sorted by name. Returns NULL on error
+static CorpusMaze *pack_mazes(const char *dir, uint32_t *count) {
+    DIR *d = opendir(dir);
+    if (!d) {
+        perror(dir);
+        return NULL;
+    }
+
+    int capacity = 64, names = 0;
+    char **files = malloc(capacity * sizeof(char *));
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (!is_maze_file(entry->d_name)) continue;
+        if (names == capacity) {
+            capacity *= 2;
+            files = realloc(files, capacity * sizeof(char *));
+        }
+        files[names++] = strdup(entry->d_name);
+    }
+    closedir(d);
+    qsort(files, names, sizeof(char *), compare_names);
+
+    CorpusMaze *mazes = malloc((names > 0 ? names : 1) * sizeof(CorpusMaze));
+    *count = 0;
+    for (int i = 0; i < names; i++) {
+        char path[MAX_PATH_LENGTH];
+        snprintf(path, sizeof(path), "%s/%s", dir, files[i]);
+        static Sim sim;
+        if (strlen(files[i]) >= CORPUS_NAME_SIZE) {
+            fprintf(stderr, "ffpack: name of %s is too long, skipped\n", path);
+        } else if (sim_load_file(&sim, path)) {
+            corpus_pack(&sim, files[i], &mazes[(*count)++]);
+        } else {
+            fprintf(stderr, "ffpack: cannot load %s, skipped\n", path);
+        }
+        free(files[i]);
+    }
+    free(files);
+    return mazes;
+}
+
+// --- Listing ---
+
+static void json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+// Damaged records are left out with a warning. Returns false if there were any
+static bool write_index(FILE *out, OutputFormat format, const Corpus *corpus) {
+    bool ok = true;
+    for (uint32_t i = 0; i < corpus->count; i++) {
+        if (corpus_maze(corpus, i) == NULL) {
+            fprintf(stderr, "ffpack: maze %lu is damaged, skipped\n", (unsigned long)i);
+            ok = false;
+        }
+    }
+
+    if (format == FORMAT_CSV) {
+        fprintf(out, "id,maze,width,height,goal\n");
+        for (uint32_t i = 0; i < corpus->count; i++) {
+            const CorpusMaze *m = corpus_maze(corpus, i);
+            if (m == NULL) continue;
+            fprintf(out, "%lu,%s,%d,%d,%s\n", (unsigned long)i, m->name, m->width, m->height,
+                    m->flags & CORPUS_HAS_GOAL ? "custom" : "centre");
+        }
+        return ok;
+    }
+
+    fprintf(out, "[\n");
+    bool first = true;
+    for (uint32_t i = 0; i < corpus->count; i++) {
+        const CorpusMaze *m = corpus_maze(corpus, i);
+        if (m == NULL) continue;
+        fprintf(out, "%s  {\"id\": %lu, \"maze\": ", first ? "" : ",\n", (unsigned long)i);
+        first = false;
+        json_string(out, m->name);
+        fprintf(out, ", \"width\": %d, \"height\": %d, \"goal\": \"%s\"}", m->width, m->height,
+                m->flags & CORPUS_HAS_GOAL ? "custom" : "centre");
+    }
+    fprintf(out, "%s]\n", first ? "" : "\n");
+    return ok;
+}
+
+// --- Main ---
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s -o corpus maze_dir\n"
+            "       %s -l [-f csv|json] corpus\n"
+            "  -o  write the mazes of maze_dir to this corpus file\n"
+            "  -l  print the id, name and size of every maze in corpus\n"
+            "  -f  index format (default: csv)\n",
+            prog, prog);
+}
+
+int main(int argc, char *argv[]) {
+    OutputFormat format = FORMAT_CSV;
+    const char *output = NULL;
+    bool list = false;
+
+    int c;
+    while ((c = getopt(argc, argv, "o:lf:h")) != -1) {
+        switch (c) {
+            case 'o': output = optarg; break;
+            case 'l': list = true; break;
+            case 'f':
+                if (strcmp(optarg, "json") == 0) {
+                    format = FORMAT_JSON;
+                } else if (strcmp(optarg, "csv") != 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (argc - optind != 1 || list == (output != NULL)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (list) {
+        Corpus corpus;
+        if (!corpus_open(&corpus, argv[optind])) return 1;
+        bool ok = write_index(stdout, format, &corpus);
+        corpus_close(&corpus);
+        return ok ? 0 : 1;
+    }
+
+    uint32_t count;
+    CorpusMaze *mazes = pack_mazes(argv[optind], &count);
+    if (!mazes) return 1;
+    if (count == 0) {
+        fprintf(stderr, "ffpack: no .num/.map files in %s\n", argv[optind]);
+        return 1;
+    }
+    if (!corpus_write(output, mazes, count)) {
+        perror(output);
+        return 1;
+    }
+    fprintf(stderr, "ffpack: %lu mazes, %lu bytes\n", (unsigned long)count,
+            (unsigned long)(sizeof(CorpusHeader) + count * sizeof(CorpusMaze)));
+    free(mazes);
+    return 0;
+}
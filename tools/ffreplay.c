@@ -0,0 +1,278 @@
+/// ffreplay.c
+/// runs the ffv3 solver (algo/ff/solver.c) against a MouseIO log recorded
+/// with SOLVER_RECORD_FILE (see algo/ff/record.h) instead of a maze: every
+/// sensor reading, move result and reset comes from the log, so a run of the
+/// real mouse or of mms repeats offline in milliseconds. any solver change
+/// that makes it act differently stops the replay at the first call it did
+/// not make in the recording.
+///
+///   gcc -O2 ffreplay.c ../algo/ff/{record,solver,grid,trace,map_image}.c -o ffreplay
+///   SOLVER_RECORD_FILE=run.rec SIM_MAZE_FILE=maze.num ../algo/ff/ff_headless.out
+///   ./ffreplay run.rec
+///   git bisect run sh -c 'gcc -O2 ffreplay.c ../algo/ff/{record,solver,grid,trace,map_image}.c -o ffreplay && ./ffreplay -q run.rec'
+///
+/// exits 0 if the solver made exactly the recorded calls and ended where the
+/// log ends, 2 if it diverged or stopped early. build it with the same
+/// -DMAZE_MAX_SIZE as the solver that made the recording, pass -p when
+/// that run loaded a saved map (SOLVER_MAP_FILE) and -b when it had a
+/// SOLVER_PLAN_BUDGET.
+
+#define _POSIX_C_SOURCE 200809L
+#include "../algo/ff/record.h"
+#include "../algo/ff/solver.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_LOG_LINE 256
+#define CONTEXT_ENTRIES 8  // Log entries shown before a divergence
+#define MAX_STEPS 1000000 // A solver that keeps replaying past this is stuck
+
+typedef enum { FORMAT_TEXT, FORMAT_JSON } OutputFormat;
+
+typedef struct {
+    long steps;
+    bool ended;      // solver_step returned false
+    int x, y, heading, mode; // Mouse pose at the start of the last step
+    double ms;       // Fastest replay
+} Result;
+
+static bool print_log = false;
+static char last_log[MAX_LOG_LINE]; // The solver's last message, often the reason it failed
+
+static void capture_log(const char *msg) {
+    snprintf(last_log, sizeof(last_log), "%s", msg);
+    if (print_log) fprintf(stderr, "%s\n", msg);
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+// --- Log File ---
+
+static uint8_t *load_log(const char *path, uint16_t *hooks, uint32_t *length) {
+    FILE *in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        return NULL;
+    }
+    RecordFileHeader header;
+    if (fread(&header, sizeof(header), 1, in) != 1 || memcmp(header.magic, RECORD_FILE_MAGIC, 4) != 0 ||
+        header.version != RECORD_FILE_VERSION) {
+        fprintf(stderr, "%s: not a version %d record file\n", path, RECORD_FILE_VERSION);
+        fclose(in);
+        return NULL;
+    }
+    *hooks = header.hooks;
+
+    uint32_t capacity = 1 << 16;
+    uint8_t *bytes = malloc(capacity);
+    *length = 0;
+    size_t got;
+    while ((got = fread(bytes + *length, 1, capacity - *length, in)) > 0) {
+        *length += (uint32_t)got;
+        if (*length == capacity) {
+            capacity *= 2;
+            bytes = realloc(bytes, capacity);
+        }
+    }
+    fclose(in);
+    return bytes;
+}
+
+// --- Replay ---
+
+static void replay_once(Solver *solver, Replay *replay, uint16_t hooks, const uint8_t *bytes, uint32_t length,
+                        MapPolicy policy, int plan_budget, Result *result) {
+    memset(result, 0, sizeof(*result));
+    const MouseIO *io = replay_start(replay, hooks, bytes, length);
+    if (!solver_init(solver, io)) {
+        result->ended = true;
+        return;
+    }
+    if (plan_budget > 0) {
+        SolverParams params = solver->params;
+        params.plan_budget = plan_budget;
+        solver_set_params(solver, &params);
+    }
+    if (policy != MAP_IGNORE) solver_load_map(solver, policy);
+
+    while (!replay->diverged && result->steps < MAX_STEPS) {
+        result->x = solver->mouse.pos.x;
+        result->y = solver->mouse.pos.y;
+        result->heading = solver->mouse.orientation;
+        result->mode = solver->mouse.mode;
+        result->steps++;
+        if (!solver_step(solver)) {
+            result->ended = true;
+            break;
+        }
+    }
+}
+
+static void call_text(char *out, size_t size, RecordCall call, int arg) {
+    if (arg >= 0) {
+        snprintf(out, size, "%s(%d)", record_call_names[call], arg);
+    } else {
+        snprintf(out, size, "%s", record_call_names[call]);
+    }
+}
+
+// The last few entries replayed before offset
+static void print_context(FILE *out, const uint8_t *bytes, uint32_t offset) {
+    uint32_t starts[CONTEXT_ENTRIES];
+    int count = 0;
+    for (uint32_t pos = 0; pos < offset;) {
+        int size = record_entry_size(bytes + pos, offset - pos);
+        if (size == 0) break;
+        starts[count++ % CONTEXT_ENTRIES] = pos;
+        pos += size;
+    }
+    int first = count > CONTEXT_ENTRIES ? count - CONTEXT_ENTRIES : 0;
+    for (int i = first; i < count; i++) {
+        const uint8_t *e = bytes + starts[i % CONTEXT_ENTRIES];
+        RecordCall call = (RecordCall)(e[0] & RECORD_CALL_MASK);
+        char text[64];
+        call_text(text, sizeof(text), call, record_entry_size(e, 2) == 2 ? e[1] : -1);
+        fprintf(out, "  %8lu  %s%s\n", (unsigned long)starts[i % CONTEXT_ENTRIES], text,
+                e[0] & RECORD_REPLY ? " -> true" : "");
+    }
+}
+
+// --- Output ---
+
+static void json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+static const char *status_of(const Replay *replay, const Result *result) {
+    if (replay->diverged) return "diverged";
+    if (!result->ended) return "stuck";
+    return replay_finished(replay) ? "finished" : "stopped_early";
+}
+
+static void write_result(FILE *out, OutputFormat format, const char *path, const Replay *replay,
+                         const Result *result) {
+    static const char *const mode_names[] = {"search", "return", "speed"};
+    const char *status = status_of(replay, result);
+    char expected[64], actual[64];
+    call_text(expected, sizeof(expected), replay->expected, replay->expected_arg);
+    call_text(actual, sizeof(actual), replay->actual, replay->actual_arg);
+
+    if (format == FORMAT_JSON) {
+        fprintf(out, "{\"log\": ");
+        json_string(out, path);
+        fprintf(out, ", \"status\": \"%s\", \"bytes\": %lu, \"replayed_bytes\": %lu, \"calls\": %ld, \"steps\": %ld, "
+                     "\"ms\": %.3f",
+                status, (unsigned long)replay->length, (unsigned long)replay->pos, replay->calls, result->steps,
+                result->ms);
+        if (replay->diverged) {
+            fprintf(out, ", \"offset\": %lu, \"expected\": \"%s\", \"actual\": \"%s\", \"x\": %d, \"y\": %d, "
+                         "\"heading\": \"%c\", \"mode\": \"%s\"",
+                    (unsigned long)replay->diverged_at, expected, actual, result->x, result->y,
+                    "NESW"[result->heading & 3], mode_names[result->mode]);
+        }
+        fprintf(out, ", \"last_log\": ");
+        json_string(out, last_log);
+        fprintf(out, "}\n");
+        return;
+    }
+
+    fprintf(out, "%s: %s, %lu of %lu bytes, %ld calls, %ld steps, %.3f ms\n", path, status,
+            (unsigned long)replay->pos, (unsigned long)replay->length, replay->calls, result->steps, result->ms);
+    if (replay->diverged) {
+        fprintf(out, "diverged at byte %lu in step %ld from (%d,%d) heading %c in %s mode: log has %s, solver called %s\n",
+                (unsigned long)replay->diverged_at, result->steps, result->x, result->y, "NESW"[result->heading & 3],
+                mode_names[result->mode], expected, actual);
+        print_context(out, replay->bytes, replay->diverged_at);
+    }
+    if (last_log[0]) fprintf(out, "last log: %s\n", last_log);
+}
+
+// --- Main ---
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-p ignore|verify|trust] [-b plan_budget] [-n repeats] [-l] [-q] [-f text|json] record_file\n"
+            "  -p  saved map policy of the recorded run (default: ignore)\n"
+            "  -b  plan budget of the recorded run (default: none)\n"
+            "  -n  replay this many times and report the fastest (default: 1)\n"
+            "  -l  print the solver's log messages to stderr\n"
+            "  -q  no output, only the exit status\n"
+            "  -f  output format (default: text)\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    MapPolicy policy = MAP_IGNORE;
+    OutputFormat format = FORMAT_TEXT;
+    int repeats = 1, plan_budget = 0;
+    bool quiet = false;
+
+    int c;
+    while ((c = getopt(argc, argv, "p:b:n:lqf:h")) != -1) {
+        switch (c) {
+            case 'p':
+                if (strcmp(optarg, "verify") == 0) {
+                    policy = MAP_VERIFY;
+                } else if (strcmp(optarg, "trust") == 0) {
+                    policy = MAP_TRUST;
+                } else if (strcmp(optarg, "ignore") != 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'b': plan_budget = atoi(optarg); break;
+            case 'n': repeats = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+            case 'l': print_log = true; break;
+            case 'q': quiet = true; break;
+            case 'f':
+                if (strcmp(optarg, "json") == 0) {
+                    format = FORMAT_JSON;
+                } else if (strcmp(optarg, "text") != 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (argc - optind != 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const char *path = argv[optind];
+    uint16_t hooks;
+    uint32_t length;
+    uint8_t *bytes = load_log(path, &hooks, &length);
+    if (!bytes) return 1;
+
+    static Solver solver;
+    static Replay replay;
+    solver_set_log(capture_log);
+    Result result;
+    double best = 0;
+    for (int i = 0; i < repeats; i++) {
+        double start = now_ms();
+        replay_once(&solver, &replay, hooks, bytes, length, policy, plan_budget, &result);
+        double ms = now_ms() - start;
+        if (i == 0 || ms < best) best = ms;
+        solver_set_log(NULL); // The repeats log the same, keep the first replay's
+    }
+    result.ms = best;
+
+    if (!quiet) write_result(stdout, format, path, &replay, &result);
+    free(bytes);
+    return replay.diverged || !replay_finished(&replay) ? 2 : 0;
+}
@@ -0,0 +1,133 @@
+/// ffresults.c
+/// prints a columnar results file (algo/ff/results.h, appended to by
+/// ffsweep -R) as csv or json, all columns or the ones picked with -c, with
+/// the rows of every append in order.
+///
+///   gcc -O2 ffresults.c ../algo/ff/results.c -o ffresults
+///   ./ffresults runs.ffr
+///   ./ffresults -c explore_bonus,maze,speed_cells -f json runs.ffr
+
+#define _POSIX_C_SOURCE 200809L
+#include "../algo/ff/results.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef enum { FORMAT_CSV, FORMAT_JSON } OutputFormat;
+
+// "a,b,c" column names into indices. Returns the count, 0 on an unknown name
+static int parse_columns(const ResultsFile *f, const char *list, int *columns) {
+    int count = 0;
+    char name[RESULTS_NAME_SIZE + 1];
+    const char *p = list;
+    while (*p && count < RESULTS_MAX_COLUMNS) {
+        size_t length = strcspn(p, ",");
+        snprintf(name, sizeof(name), "%.*s", (int)length, p);
+        columns[count] = results_column(f, name);
+        if (columns[count] < 0) {
+            fprintf(stderr, "ffresults: no column %s\n", name);
+            return 0;
+        }
+        count++;
+        p += length;
+        if (*p == ',') p++;
+    }
+    return count;
+}
+
+static void write_value(FILE *out, const ResultsFile *f, const ResultsBlock *block, int column, uint32_t row) {
+    const ResultsValue *v = &block->values[(size_t)column * block->rows + row];
+    if (f->columns[column].type == RESULTS_REAL) {
+        fprintf(out, "%.3f", v->r);
+    } else {
+        fprintf(out, "%lld", (long long)v->i);
+    }
+}
+
+static void write_rows(FILE *out, OutputFormat format, const ResultsFile *f, const int *columns, int count) {
+    if (format == FORMAT_CSV) {
+        for (int c = 0; c < count; c++) fprintf(out, "%s%s", c ? "," : "", f->columns[columns[c]].name);
+        fprintf(out, "\n");
+    } else {
+        fprintf(out, "[\n");
+    }
+
+    long written = 0;
+    size_t offset = 0;
+    ResultsBlock block;
+    while (results_next_block(f, &offset, &block)) {
+        for (uint32_t r = 0; r < block.rows; r++) {
+            written++;
+            if (format == FORMAT_JSON) fprintf(out, "  {");
+            for (int c = 0; c < count; c++) {
+                if (format == FORMAT_JSON) {
+                    fprintf(out, "%s\"%s\": ", c ? ", " : "", f->columns[columns[c]].name);
+                } else if (c) {
+                    fputc(',', out);
+                }
+                write_value(out, f, &block, columns[c], r);
+            }
+            if (format == FORMAT_JSON) fprintf(out, "}%s", written < f->rows ? "," : "");
+            fprintf(out, "\n");
+        }
+    }
+    if (format == FORMAT_JSON) fprintf(out, "]\n");
+}
+
+// --- Main ---
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-c columns] [-f csv|json] [-o output] results_file\n"
+            "  -c  columns to print, \"a,b,c\" (default: all)\n"
+            "  -f  output format (default: csv)\n"
+            "  -o  output file (default: stdout)\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    OutputFormat format = FORMAT_CSV;
+    const char *output = NULL, *column_list = NULL;
+
+    int c;
+    while ((c = getopt(argc, argv, "c:f:o:h")) != -1) {
+        switch (c) {
+            case 'c': column_list = optarg; break;
+            case 'f':
+                if (strcmp(optarg, "json") == 0) {
+                    format = FORMAT_JSON;
+                } else if (strcmp(optarg, "csv") != 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'o': output = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (argc - optind != 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    ResultsFile f;
+    if (!results_open(&f, argv[optind])) return 1;
+    int columns[RESULTS_MAX_COLUMNS], count = f.column_count;
+    if (column_list) {
+        count = parse_columns(&f, column_list, columns);
+        if (count == 0) return 1;
+    } else {
+        for (int i = 0; i < count; i++) columns[i] = i;
+    }
+
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        perror(output);
+        return 1;
+    }
+    write_rows(out, format, &f, columns, count);
+    if (out != stdout) fclose(out);
+    results_close(&f);
+    return 0;
+}
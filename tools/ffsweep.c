@@ -0,0 +1,290 @@
+/// ffsweep.c
+/// parameter sweep of the ffv3 search heuristics over a maze directory or a
+/// packed corpus (algo/ff/corpus.h, written by ffpack.c): every maze is
+/// solved in-process under every parameter set by the batch api
+/// (algo/ff/batch.h), one work-stealing worker per core, and one row of
+/// summed metrics is written per parameter set. -e and -m together sweep
+/// every combination of their values. -R also appends every single run to a
+/// columnar results file (algo/ff/results.h, printed by ffresults.c).
+/// the mouse is configured like ffbench's: no diagonal moves and no planning
+/// during moves unless -d / -p ask for them, as SIM_DIAGONALS / SIM_PIPELINE.
+///
+///   gcc -O2 -pthread ffsweep.c ../algo/ff/{batch,corpus,results,solver,grid,trace,map_image,sim}.c -o ffsweep
+///   ./ffsweep -e 0,1,2,3,4 mazes/
+///   ./ffsweep -e -2:6 -f json -o sweep.json mazes/   # explore bonus -2 to 6
+///   ./ffsweep -m 0,500,1000,2000 mazes/               # min_verify_saving (ms)
+///   ./ffsweep -e 0:4 -R runs.ffr mazes.ffmz           # every run of a corpus
+///
+/// add -DMAZE_MAX_SIZE=32 to the solver build for half-size mazes.
+
+#define _POSIX_C_SOURCE 200809L
+#include "../algo/ff/batch.h"
+#include "../algo/ff/results.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_PATH_LENGTH 1024
+#define MAX_PARAM_SETS 1024
+
+typedef enum { FORMAT_CSV, FORMAT_JSON } OutputFormat;
+
+// -R columns, one row per run. maze is the corpus id, or the index in the
+// sorted directory listing, which is the same id once ffpack packed it
+static const ResultsColumn run_columns[] = {
+    {"explore_bonus", RESULTS_INT}, {"min_verify_saving", RESULTS_INT}, {"maze", RESULTS_INT},
+    {"fits", RESULTS_INT},          {"finished", RESULTS_INT},          {"reached_goal", RESULTS_INT},
+    {"search_cells", RESULTS_INT},  {"search_turns", RESULTS_INT},      {"return_cells", RESULTS_INT},
+    {"return_turns", RESULTS_INT},  {"explore_cells", RESULTS_INT},     {"speed_cells", RESULTS_INT},
+    {"speed_turns", RESULTS_INT},   {"moves", RESULTS_INT},             {"turns", RESULTS_INT},
+    {"crashes", RESULTS_INT},       {"cells_touched", RESULTS_INT},     {"flood_fill_ms", RESULTS_REAL},
+    {"cpu_ms", RESULTS_REAL}};
+
+#define RUN_COLUMNS ((int)(sizeof(run_columns) / sizeof(run_columns[0])))
+
+// --- Maze Discovery ---
+
+static bool is_maze_file(const char *name) {
+    const char *ext = strrchr(name, '.');
+    return ext && (strcmp(ext, ".num") == 0 || strcmp(ext, ".map") == 0);
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Loads every maze file in dir, sorted by name. Returns NULL on error
+static Sim *load_mazes(const char *dir, int *count) {
+    DIR *d = opendir(dir);
+    if (!d) {
+        perror(dir);
+        return NULL;
+    }
+
+    int capacity = 64, names = 0;
+    char **paths = malloc(capacity * sizeof(char *));
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (!is_maze_file(entry->d_name)) continue;
+        if (names == capacity) {
+            capacity *= 2;
+            paths = realloc(paths, capacity * sizeof(char *));
+        }
+        paths[names] = malloc(MAX_PATH_LENGTH);
+        snprintf(paths[names++], MAX_PATH_LENGTH, "%s/%s", dir, entry->d_name);
+    }
+    closedir(d);
+    qsort(paths, names, sizeof(char *), compare_names);
+
+    Sim *mazes = malloc((names > 0 ? names : 1) * sizeof(Sim));
+    *count = 0;
+    for (int i = 0; i < names; i++) {
+        if (sim_load_file(&mazes[*count], paths[i])) {
+            (*count)++;
+        } else {
+            fprintf(stderr, "ffsweep: cannot load %s, skipped\n", paths[i]);
+        }
+        free(paths[i]);
+    }
+    free(paths);
+    return mazes;
+}
+
+// --- Parameter Sets ---
+
+// "a,b,c" or "lo:hi". Returns the count, 0 on a bad list
+static int parse_values(const char *list, long *values, int max) {
+    int lo, hi, count = 0;
+    char rest;
+    if (sscanf(list, "%d:%d%c", &lo, &hi, &rest) == 2) {
+        for (int v = lo; v <= hi && count < max; v++) values[count++] = v;
+        return count;
+    }
+
+    const char *p = list;
+    while (*p && count < max) {
+        char *end;
+        long v = strtol(p, &end, 10);
+        if (end == p || (*end != ',' && *end != '\0')) return 0;
+        values[count++] = v;
+        p = *end == ',' ? end + 1 : end;
+    }
+    return count;
+}
+
+// --- Output ---
+
+// Appends every run as one block, in job order
+static bool append_runs(const char *path, const SolverParams *params, const BatchRun *runs, int maze_count,
+                        int param_count) {
+    uint32_t rows = (uint32_t)(maze_count * param_count);
+    ResultsValue *values = malloc(((size_t)rows * RUN_COLUMNS + 1) * sizeof(ResultsValue));
+    if (!values) return false;
+    for (uint32_t j = 0; j < rows; j++) {
+        const BatchRun *run = &runs[j];
+        const SolverParams *p = &params[j / maze_count];
+        const SimStats *st = &run->stats;
+        int64_t ints[] = {p->explore_bonus,   p->min_verify_saving, j % maze_count,    run->fits,
+                          run->finished,      st->reached_goal,     st->search_cells,  st->search_turns,
+                          st->return_cells,   st->return_turns,     st->explore_cells, st->speed_cells,
+                          st->speed_turns,    st->moves,            st->turns,         st->crashes,
+                          run->cells_touched};
+        int c = 0;
+        for (; c < (int)(sizeof(ints) / sizeof(ints[0])); c++) values[(size_t)c * rows + j].i = ints[c];
+        values[(size_t)c++ * rows + j].r = st->flood_fill_ms;
+        values[(size_t)c * rows + j].r = run->cpu_ms;
+    }
+    bool ok = results_append(path, run_columns, RUN_COLUMNS, values, rows);
+    free(values);
+    return ok;
+}
+
+static void write_results(FILE *out, OutputFormat format, const SolverParams *params, const BatchTotals *totals,
+                          int count) {
+    if (format == FORMAT_CSV) {
+        fprintf(out, "explore_bonus,min_verify_saving,runs,reached_goal,failed,search_cells,search_turns,explore_cells,"
+                     "speed_cells,speed_turns,moves,turns,crashes,cells_touched,cpu_ms\n");
+        for (int i = 0; i < count; i++) {
+            const BatchTotals *t = &totals[i];
+            fprintf(out, "%d,%lu,%d,%d,%d,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%.1f\n", params[i].explore_bonus,
+                    (unsigned long)params[i].min_verify_saving, t->runs, t->reached_goal, t->failed, t->search_cells,
+                    t->search_turns, t->explore_cells, t->speed_cells, t->speed_turns, t->moves, t->turns, t->crashes,
+                    t->cells_touched, t->cpu_ms);
+        }
+        return;
+    }
+
+    fprintf(out, "[\n");
+    for (int i = 0; i < count; i++) {
+        const BatchTotals *t = &totals[i];
+        fprintf(out,
+                "  {\"explore_bonus\": %d, \"min_verify_saving\": %lu, \"runs\": %d, \"reached_goal\": %d, \"failed\": %d, "
+                "\"search_cells\": %ld, \"search_turns\": %ld, \"explore_cells\": %ld, \"speed_cells\": %ld, "
+                "\"speed_turns\": %ld, \"moves\": %ld, \"turns\": %ld, \"crashes\": %ld, \"cells_touched\": %ld, "
+                "\"cpu_ms\": %.1f}%s\n",
+                params[i].explore_bonus, (unsigned long)params[i].min_verify_saving, t->runs, t->reached_goal, t->failed, t->search_cells, t->search_turns,
+                t->explore_cells, t->speed_cells, t->speed_turns, t->moves, t->turns, t->crashes, t->cells_touched,
+                t->cpu_ms, i + 1 < count ? "," : "");
+    }
+    fprintf(out, "]\n");
+}
+
+// --- Main ---
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-e values] [-m values] [-j jobs] [-s max_steps] [-d] [-p] [-f csv|json] [-o output] [-R runs]\n"
+            "          maze_dir|corpus\n"
+            "  -e  explore bonus values, \"a,b,c\" or \"lo:hi\" (default: %d)\n"
+            "  -m  min_verify_saving values in ms, same forms (default: %d)\n"
+            "  -j  worker threads (default: number of online cores)\n"
+            "  -s  step limit per run (default: %d)\n"
+            "  -d  diagonal speed runs, as SIM_DIAGONALS=1\n"
+            "  -p  plan search steps during moves and sense cells on entry, as SIM_PIPELINE=1\n"
+            "  -f  output format (default: csv)\n"
+            "  -o  output file (default: stdout)\n"
+            "  -R  append every run to this results file\n",
+            prog, EXPLORE_BONUS_DEFAULT, VERIFY_SAVING_DEFAULT, SIM_DEFAULT_MAX_STEPS);
+}
+
+int main(int argc, char *argv[]) {
+    static SolverParams params[MAX_PARAM_SETS];
+    static long bonuses[MAX_PARAM_SETS] = {EXPLORE_BONUS_DEFAULT}, savings[MAX_PARAM_SETS] = {VERIFY_SAVING_DEFAULT};
+    int bonus_count = 1, saving_count = 1;
+    BatchConfig cfg = {0};
+    OutputFormat format = FORMAT_CSV;
+    const char *output = NULL, *runs_path = NULL;
+
+    int c;
+    while ((c = getopt(argc, argv, "e:m:j:s:dpf:o:R:h")) != -1) {
+        switch (c) {
+            case 'e':
+                bonus_count = parse_values(optarg, bonuses, MAX_PARAM_SETS);
+                if (bonus_count == 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'm':
+                saving_count = parse_values(optarg, savings, MAX_PARAM_SETS);
+                if (saving_count == 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'j': cfg.threads = atoi(optarg); break;
+            case 's': cfg.max_steps = atol(optarg); break;
+            case 'd': cfg.diagonals = true; break;
+            case 'p': cfg.pipeline = true; break;
+            case 'f':
+                if (strcmp(optarg, "json") == 0) {
+                    format = FORMAT_JSON;
+                } else if (strcmp(optarg, "csv") != 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'o': output = optarg; break;
+            case 'R': runs_path = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (argc - optind != 1 || bonus_count * saving_count > MAX_PARAM_SETS) {
+        usage(argv[0]);
+        return 1;
+    }
+    for (int i = 0; i < saving_count; i++) {
+        if (savings[i] < 0) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    int param_count = 0;
+    for (int b = 0; b < bonus_count; b++) {
+        for (int m = 0; m < saving_count; m++) {
+            params[param_count] = solver_default_params();
+            params[param_count].explore_bonus = (int)bonuses[b];
+            params[param_count++].min_verify_saving = (uint32_t)savings[m];
+        }
+    }
+
+    // A corpus is mapped, not loaded: each worker unpacks the mazes it runs
+    Corpus corpus = {0};
+    Sim *mazes = NULL;
+    if (corpus_is_file(argv[optind])) {
+        if (!corpus_open(&corpus, argv[optind])) return 1;
+        cfg.corpus = &corpus;
+        cfg.maze_count = (int)corpus.count;
+    } else {
+        mazes = load_mazes(argv[optind], &cfg.maze_count);
+        if (!mazes) return 1;
+        cfg.mazes = mazes;
+    }
+    cfg.params = params;
+    cfg.param_count = param_count;
+
+    BatchTotals *totals = malloc(param_count * sizeof(BatchTotals));
+    BatchRun *runs = runs_path ? malloc(((size_t)cfg.maze_count * param_count + 1) * sizeof(BatchRun)) : NULL;
+    if (!batch_run(&cfg, totals, runs)) {
+        fprintf(stderr, "ffsweep: no worker thread could start\n");
+        return 1;
+    }
+    if (runs_path && !append_runs(runs_path, params, runs, cfg.maze_count, param_count)) return 1;
+
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        perror(output);
+        return 1;
+    }
+    write_results(out, format, params, totals, param_count);
+    if (out != stdout) fclose(out);
+
+    free(runs);
+    free(totals);
+    free(mazes);
+    corpus_close(&corpus);
+    return 0;
+}
@@ -0,0 +1,281 @@
+/// floodbench.c
+/// times the two full-rebuild flood fill engines in algo/ff/solver.c, the
+/// queue BFS and the bit-parallel wavefront, against each other on every
+/// maze in a directory, and checks that they give identical distances. each
+/// maze is filled twice: from the goal on the complete wall map, and from
+/// the start on the map a mouse has before its first run (outer walls only).
+///
+///   gcc -O2 floodbench.c ../algo/ff/{solver,grid,trace,map_image,sim}.c -o floodbench
+///   ./floodbench -n 2000 mazes/
+///   ./floodbench -f json -o flood.json mazes/
+///
+/// exits non-zero if the engines disagree on any maze. add
+/// -DMAZE_MAX_SIZE=32 to the solver build for half-size mazes.
+
+#define _POSIX_C_SOURCE 200809L
+#include "../algo/ff/sim.h"
+#include "../algo/ff/solver.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_PATH_LENGTH 1024
+
+typedef enum { FORMAT_CSV, FORMAT_JSON } OutputFormat;
+typedef enum { CASE_GOAL_FULL_MAP, CASE_START_EMPTY_MAP, CASE_COUNT } BenchCase;
+typedef void (*FloodEngine)(Maze *m, DistanceField *f, const MazeRow *seeds);
+
+static const char *const case_names[CASE_COUNT] = {"goal_full_map", "start_empty_map"};
+
+typedef struct {
+    char maze[MAX_PATH_LENGTH];
+    const char *status; // "ok", "load_failed", "too_large" or "mismatch"
+    int width, height;
+    int cells_reached[CASE_COUNT];
+    double queue_ns[CASE_COUNT];     // Per fill, best of the repeats
+    double wavefront_ns[CASE_COUNT];
+} Result;
+
+// Solver state, too large for the stack
+typedef struct {
+    Maze maze;
+    DistanceField queue_field;
+    DistanceField wavefront_field;
+} Bench;
+
+// --- Maze Discovery ---
+
+static bool is_maze_file(const char *name) {
+    const char *ext = strrchr(name, '.');
+    return ext && (strcmp(ext, ".num") == 0 || strcmp(ext, ".map") == 0);
+}
+
+static int compare_results(const void *a, const void *b) {
+    return strcmp(((const Result *)a)->maze, ((const Result *)b)->maze);
+}
+
+// Returns the sorted maze files in dir as unmeasured results, NULL on error
+static Result *list_mazes(const char *dir, int *count) {
+    DIR *d = opendir(dir);
+    if (!d) {
+        perror(dir);
+        return NULL;
+    }
+
+    int capacity = 64;
+    Result *results = malloc(capacity * sizeof(Result));
+    *count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (!is_maze_file(entry->d_name)) continue;
+        if (*count == capacity) {
+            capacity *= 2;
+            results = realloc(results, capacity * sizeof(Result));
+        }
+        Result *r = &results[(*count)++];
+        memset(r, 0, sizeof(*r));
+        snprintf(r->maze, sizeof(r->maze), "%s/%s", dir, entry->d_name);
+    }
+    closedir(d);
+    qsort(results, *count, sizeof(Result), compare_results);
+    return results;
+}
+
+// --- Timing ---
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Best per-fill time over a few batches of repeats, so one preemption does not count
+static double time_engine(Bench *b, FloodEngine engine, DistanceField *f, const MazeRow *seeds, int repeats) {
+    double best = 0;
+    for (int batch = 0; batch < 5; batch++) {
+        double start = now_ns();
+        for (int i = 0; i < repeats; i++) {
+            for (int c = 0; c < GRID_CELLS; c++) f->distances[c] = INVALID_DISTANCE;
+            engine(&b->maze, f, seeds);
+        }
+        double per_fill = (now_ns() - start) / repeats;
+        if (batch == 0 || per_fill < best) best = per_fill;
+    }
+    return best;
+}
+
+// --- Measuring ---
+
+static bool measure_case(Bench *b, Result *r, BenchCase bc, int repeats) {
+    MazeRow seeds[MAZE_MAX_HEIGHT] = {0};
+    if (bc == CASE_GOAL_FULL_MAP) {
+        memcpy(seeds, b->maze.goal, sizeof(seeds));
+    } else {
+        seeds[0] = 1;
+    }
+
+    r->queue_ns[bc] = time_engine(b, flood_fill_queue, &b->queue_field, seeds, repeats);
+    r->wavefront_ns[bc] = time_engine(b, flood_fill_wavefront, &b->wavefront_field, seeds, repeats);
+
+    for (int y = 0; y < r->height; y++) {
+        for (int x = 0; x < r->width; x++) {
+            CellIndex c = grid_index((Point){x, y});
+            if (b->queue_field.distances[c] != b->wavefront_field.distances[c]) return false;
+            if (b->queue_field.distances[c] != INVALID_DISTANCE) r->cells_reached[bc]++;
+        }
+    }
+    return true;
+}
+
+static void measure(Bench *b, Result *r, int repeats) {
+    Sim sim;
+    if (!sim_load_file(&sim, r->maze)) {
+        r->status = "load_failed";
+        return;
+    }
+    r->width = sim.width;
+    r->height = sim.height;
+    if (!init_maze(&b->maze, sim.width, sim.height)) {
+        r->status = "too_large";
+        return;
+    }
+
+    r->status = "ok";
+    if (!measure_case(b, r, CASE_START_EMPTY_MAP, repeats)) r->status = "mismatch";
+
+    for (int x = 0; x < sim.width; x++) {
+        for (int y = 0; y < sim.height; y++) {
+            for (Direction dir = 0; dir < DIRECTION_COUNT; dir++) {
+                if ((sim.walls[x][y] >> dir) & 1) set_wall(&b->maze, (Point){x, y}, dir);
+            }
+        }
+    }
+    if (!measure_case(b, r, CASE_GOAL_FULL_MAP, repeats)) r->status = "mismatch";
+}
+
+// --- Output ---
+
+static void json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+static void write_results(FILE *out, OutputFormat format, const Result *results, int count) {
+    if (format == FORMAT_CSV) {
+        fprintf(out, "maze,status,width,height,case,cells_reached,queue_ns,wavefront_ns,speedup\n");
+        for (int i = 0; i < count; i++) {
+            const Result *r = &results[i];
+            for (int bc = 0; bc < CASE_COUNT; bc++) {
+                fprintf(out, "%s,%s,%d,%d,%s,%d,%.1f,%.1f,%.2f\n", r->maze, r->status, r->width, r->height,
+                        case_names[bc], r->cells_reached[bc], r->queue_ns[bc], r->wavefront_ns[bc],
+                        r->wavefront_ns[bc] > 0 ? r->queue_ns[bc] / r->wavefront_ns[bc] : 0.0);
+            }
+        }
+        return;
+    }
+
+    fprintf(out, "[\n");
+    for (int i = 0; i < count; i++) {
+        const Result *r = &results[i];
+        for (int bc = 0; bc < CASE_COUNT; bc++) {
+            fprintf(out, "  {\"maze\": ");
+            json_string(out, r->maze);
+            fprintf(out,
+                    ", \"status\": \"%s\", \"width\": %d, \"height\": %d, \"case\": \"%s\", "
+                    "\"cells_reached\": %d, \"queue_ns\": %.1f, \"wavefront_ns\": %.1f}%s\n",
+                    r->status, r->width, r->height, case_names[bc], r->cells_reached[bc], r->queue_ns[bc],
+                    r->wavefront_ns[bc], i + 1 < count || bc + 1 < CASE_COUNT ? "," : "");
+        }
+    }
+    fprintf(out, "]\n");
+}
+
+// Totals per case on stderr, over the mazes that measured ok
+static void print_summary(const Result *results, int count) {
+    for (int bc = 0; bc < CASE_COUNT; bc++) {
+        double queue = 0, wavefront = 0;
+        int mazes = 0;
+        for (int i = 0; i < count; i++) {
+            if (strcmp(results[i].status, "ok") != 0) continue;
+            queue += results[i].queue_ns[bc];
+            wavefront += results[i].wavefront_ns[bc];
+            mazes++;
+        }
+        if (mazes == 0) continue;
+        fprintf(stderr, "floodbench: %-15s %d mazes, queue %.1f ns/fill, wavefront %.1f ns/fill (%.2fx)\n",
+                case_names[bc], mazes, queue / mazes, wavefront / mazes, wavefront > 0 ? queue / wavefront : 0.0);
+    }
+}
+
+// --- Main ---
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-n repeats] [-f csv|json] [-o output] maze_dir\n"
+            "  -n  fills per timed batch (default: 1000)\n"
+            "  -f  output format (default: csv)\n"
+            "  -o  output file (default: stdout)\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    int repeats = 1000;
+    OutputFormat format = FORMAT_CSV;
+    const char *output = NULL;
+
+    int c;
+    while ((c = getopt(argc, argv, "n:f:o:h")) != -1) {
+        switch (c) {
+            case 'n': repeats = atoi(optarg); break;
+            case 'f':
+                if (strcmp(optarg, "json") == 0) {
+                    format = FORMAT_JSON;
+                } else if (strcmp(optarg, "csv") != 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'o': output = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (repeats < 1) repeats = 1;
+    if (argc - optind != 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int count;
+    Result *results = list_mazes(argv[optind], &count);
+    if (!results) return 1;
+
+    Bench *bench = malloc(sizeof(Bench));
+    int mismatches = 0;
+    for (int i = 0; i < count; i++) {
+        measure(bench, &results[i], repeats);
+        if (strcmp(results[i].status, "mismatch") == 0) {
+            fprintf(stderr, "floodbench: engines disagree on %s\n", results[i].maze);
+            mismatches++;
+        }
+    }
+    free(bench);
+
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        perror(output);
+        return 1;
+    }
+    write_results(out, format, results, count);
+    if (out != stdout) fclose(out);
+    print_summary(results, count);
+
+    free(results);
+    return mismatches ? 2 : 0;
+}
@@ -0,0 +1,86 @@
+/// gengeometry.c
+/// emits algo/ff/maze_geometry.h: the empty maze init_maze() builds for one
+/// maze size (cell flags and goal rows for the default centre goal, outer
+/// wall planes and their wall log) and the goal distances of its first flood
+/// fill, as static const tables. a solver built with -DSOLVER_FIXED_GEOMETRY copies them instead
+/// of computing them, so on the mouse they stay in flash and the startup
+/// cost is a few memcpys.
+///
+///   gcc -O2 gengeometry.c ../algo/ff/{solver,grid,trace,map_image}.c -o gengeometry
+///   ./gengeometry 16 16 > ../algo/ff/maze_geometry.h
+///
+/// the tables are for the generator's own MAZE_MAX_SIZE, build it with the
+/// same -DMAZE_MAX_SIZE as the solver they are for.
+
+#include "../algo/ff/solver.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Values per line in the emitted arrays
+#define PER_LINE 16
+
+static void emit_bytes(const char *type, const char *name, const char *size, const uint8_t *v, int count) {
+    printf("static const %s %s[%s] = {", type, name, size);
+    for (int i = 0; i < count; i++) printf("%s0x%02X,", i % PER_LINE ? " " : "\n    ", v[i]);
+    printf("\n};\n\n");
+}
+
+static void emit_words(const char *type, const char *name, const char *size, const uint16_t *v, int count) {
+    printf("static const %s %s[%s] = {", type, name, size);
+    for (int i = 0; i < count; i++) printf("%s%u,", i % PER_LINE ? " " : "\n    ", v[i]);
+    printf("\n};\n\n");
+}
+
+static void emit_rows(const char *name, const char *size, const MazeRow *v, int count) {
+    printf("static const MazeRow %s[%s] = {", name, size);
+    for (int i = 0; i < count; i++) {
+        printf("%s0x%0*lX,", i % (PER_LINE / 2) ? " " : "\n    ", (int)(2 * sizeof(MazeRow)), (unsigned long)v[i]);
+    }
+    printf("\n};\n\n");
+}
+
+int main(int argc, char *argv[]) {
+    int width = argc > 1 ? atoi(argv[1]) : MAZE_MAX_WIDTH;
+    int height = argc > 2 ? atoi(argv[2]) : width;
+
+    static Maze maze;
+    if (argc > 3 || !init_maze(&maze, width, height)) {
+        fprintf(stderr, "usage: %s [width [height]], at most %dx%d in this build\n", argv[0], MAZE_MAX_WIDTH,
+                MAZE_MAX_HEIGHT);
+        return 1;
+    }
+    flood_fill_goal(&maze);
+    const CellGraph *g = &maze.graph;
+
+    printf("#pragma once\n"
+           "#include \"solver.h\"\n"
+           "\n"
+           "// maze_geometry.h\n"
+           "// Generated by tools/gengeometry.c for a %dx%d maze in a MAZE_MAX_SIZE=%d build, do not edit.\n"
+           "// The state init_maze() and the first flood_fill_goal() produce, copied by\n"
+           "// init_maze() when the solver is built with -DSOLVER_FIXED_GEOMETRY.\n"
+           "\n"
+           "#if MAZE_MAX_SIZE != %d\n"
+           "#error \"maze_geometry.h was generated for MAZE_MAX_SIZE=%d, rerun tools/gengeometry.c\"\n"
+           "#endif\n"
+           "\n"
+           "#define GEOMETRY_WIDTH %d\n"
+           "#define GEOMETRY_HEIGHT %d\n"
+           "#define GEOMETRY_WALL_VERSION %u // Outer wall segments, all logged\n"
+           "\n",
+           width, height, MAZE_MAX_SIZE, MAZE_MAX_SIZE, MAZE_MAX_SIZE, width, height, maze.wall_version);
+
+    printf("// Cell flags by CellIndex: outer walls, goal mask, border\n");
+    emit_bytes("uint8_t", "geometry_flags", "GRID_CELLS", g->flags, GRID_CELLS);
+    printf("// Goal cells by row, see Maze\n");
+    emit_rows("geometry_goal", "MAZE_MAX_HEIGHT", maze.goal, MAZE_MAX_HEIGHT);
+    printf("// Wall planes, see Maze\n");
+    emit_rows("geometry_h_walls", "MAZE_MAX_HEIGHT + 1", maze.h_walls, MAZE_MAX_HEIGHT + 1);
+    emit_rows("geometry_v_walls", "MAZE_MAX_WIDTH + 1", maze.v_walls, MAZE_MAX_WIDTH + 1);
+    emit_rows("geometry_e_walls", "MAZE_MAX_HEIGHT", maze.e_walls, MAZE_MAX_HEIGHT);
+    printf("// Maze.wall_log entries of the outer walls\n");
+    emit_words("uint16_t", "geometry_wall_log", "GEOMETRY_WALL_VERSION", maze.wall_log, maze.wall_version);
+    printf("// Goal distances on the empty maze, Manhattan distance to the goal area\n");
+    emit_words("uint16_t", "geometry_goal_distances", "GRID_CELLS", maze.fields[FIELD_GOAL].distances, GRID_CELLS);
+    return 0;
+}
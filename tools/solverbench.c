@@ -0,0 +1,486 @@
+/// solverbench.c
+/// microbenchmarks of the ffv3 solver kernels (algo/ff/solver.c) on maze
+/// snapshots: every maze in a directory is solved once in-process against
+/// the headless simulator, the solver state is copied at fixed points of
+/// the run, and each kernel is then timed on those copies. a kernel is
+/// repeated (doubling the count) until a batch takes at least -t ms, and
+/// reported as ns/op and cells/sec.
+///
+///   gcc -O2 solverbench.c ../algo/ff/{solver,grid,trace,map_image,sim}.c -o solverbench
+///   ./solverbench -f json -o base.json mazes/
+///   ./solverbench -b base.json -r 10 mazes/   # exits 3 if a kernel got >10% slower
+///
+/// the baseline is any earlier json output of this tool, joined on maze
+/// basename, snapshot and kernel, so two builds of the solver (flood fill
+/// engine, MAZE_MAX_SIZE, compiler flags) can be compared kernel by kernel.
+/// update_display is timed against display hooks that only format the mms
+/// commands into memory, so it measures the solver side, not the pipe.
+
+#define _POSIX_C_SOURCE 200809L
+#include "../algo/ff/sim.h"
+#include "../algo/ff/solver.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_PATH_LENGTH 1024
+#define MAX_LINE 2048
+#define SEARCH_SNAPSHOT_STEP 64 // Search steps before the early snapshot
+
+typedef enum { FORMAT_CSV, FORMAT_JSON } OutputFormat;
+
+// Points of the run the solver state is copied at
+typedef enum {
+    SNAPSHOT_SEARCH, // SEARCH_SNAPSHOT_STEP steps into the search run
+    SNAPSHOT_GOAL,   // First goal arrival, the return trip about to start
+    SNAPSHOT_SPEED,  // Speed run about to start, the map as complete as it gets
+    SNAPSHOT_COUNT
+} SnapshotKind;
+
+static const char *const snapshot_names[SNAPSHOT_COUNT] = {"search", "goal", "speed"};
+
+// Scratch of the display hooks: one frame of mms commands
+typedef struct {
+    char text[64 * 1024];
+    int length;
+} DisplayBuffer;
+
+typedef struct {
+    Solver solver;
+    PathPlanner planner;
+    DisplayBuffer display;
+    MouseIO display_io;
+} Workspace;
+
+// Runs the kernel once on w, returns the cells it processed
+typedef long (*KernelFn)(Workspace *w);
+
+typedef struct {
+    const char *name;
+    KernelFn run;
+    void (*prepare)(Workspace *w); // Optional, once before timing
+} Kernel;
+
+typedef struct {
+    char maze[MAX_PATH_LENGTH];
+    const char *snapshot;
+    const char *kernel;
+    long iterations;
+    double ns_per_op;
+    double cells_per_sec;
+    double baseline_ns; // 0 if not in the baseline
+} Result;
+
+typedef struct {
+    Result *items;
+    int count, capacity;
+} ResultList;
+
+// --- Kernels ---
+
+// Full rebuilds: the cached field is dropped first so nothing is repaired
+static long run_flood_fill(Workspace *w) {
+    Maze *m = &w->solver.maze;
+    m->fields[FIELD_START].kind = FLOOD_NONE;
+    m->cells_touched = 0;
+    flood_fill(m, (Point){0, 0});
+    return m->cells_touched;
+}
+
+static long run_flood_fill_goal(Workspace *w) {
+    Maze *m = &w->solver.maze;
+    m->fields[FIELD_GOAL].kind = FLOOD_NONE;
+    m->cells_touched = 0;
+    flood_fill_goal(m);
+    return m->cells_touched;
+}
+
+// Exploration planning, unsensed walls open, so it finds a path at every snapshot
+static long run_compute_shortest_path(Workspace *w) {
+    Maze *m = &w->solver.maze;
+    compute_shortest_path(&w->solver.mouse, m, &w->planner, false);
+    return (long)m->graph.width * m->graph.height;
+}
+
+static void prepare_path(Workspace *w) {
+    compute_shortest_path(&w->solver.mouse, &w->solver.maze, &w->planner, false);
+}
+
+static long run_verify_path_exploration(Workspace *w) {
+    volatile bool verified = verify_path_exploration(&w->solver.mouse, &w->solver.maze);
+    (void)verified;
+    return w->solver.mouse.path_length;
+}
+
+static void prepare_goal_field(Workspace *w) {
+    flood_fill_goal(&w->solver.maze);
+}
+
+static long run_choose_next_direction(Workspace *w) {
+    volatile Direction dir = choose_next_direction(&w->solver.mouse, &w->solver.maze);
+    (void)dir;
+    return 1;
+}
+
+static long run_update_display(Workspace *w) {
+    w->display.length = 0;
+    update_display(&w->solver);
+    return (long)w->solver.maze.graph.width * w->solver.maze.graph.height;
+}
+
+static const Kernel kernels[] = {
+    {"flood_fill", run_flood_fill, NULL},
+    {"flood_fill_goal", run_flood_fill_goal, NULL},
+    {"compute_shortest_path", run_compute_shortest_path, NULL},
+    {"verify_path_exploration", run_verify_path_exploration, prepare_path},
+    {"choose_next_direction", run_choose_next_direction, prepare_goal_field},
+    {"update_display", run_update_display, NULL},
+};
+#define KERNEL_COUNT ((int)(sizeof(kernels) / sizeof(kernels[0])))
+
+// --- Display Serialisation ---
+
+static void display_append(DisplayBuffer *d, const char *format, int x, int y, const char *arg) {
+    int room = (int)sizeof(d->text) - d->length;
+    int n = snprintf(d->text + d->length, room, format, x, y, arg);
+    if (n > 0 && n < room) d->length += n;
+}
+
+static void display_set_wall(void *ctx, int x, int y, char direction) {
+    char arg[2] = {direction, '\0'};
+    display_append(ctx, "setWall %d %d %s\n", x, y, arg);
+}
+
+static void display_set_color(void *ctx, int x, int y, char color) {
+    char arg[2] = {color, '\0'};
+    display_append(ctx, "setColor %d %d %s\n", x, y, arg);
+}
+
+static void display_set_text(void *ctx, int x, int y, const char *text) {
+    display_append(ctx, "setText %d %d %s\n", x, y, text);
+}
+
+static void display_clear(void *ctx) {
+    ((DisplayBuffer *)ctx)->length = 0;
+}
+
+// Points the workspace's solver at hooks that only draw into w->display
+static void bind_display(Workspace *w) {
+    memset(&w->display_io, 0, sizeof(w->display_io));
+    w->display_io.ctx = &w->display;
+    w->display_io.set_wall = display_set_wall;
+    w->display_io.set_color = display_set_color;
+    w->display_io.set_text = display_set_text;
+    w->display_io.clear_display = display_clear;
+    w->solver.io = &w->display_io;
+}
+
+// --- Snapshots ---
+
+// Solves the maze, copying the solver at each snapshot point. Returns a bitmask
+// of the snapshots taken (a maze solved in fewer search steps has no "search")
+static int take_snapshots(const char *path, Solver *snapshots) {
+    Sim sim;
+    if (!sim_load_file(&sim, path)) return 0;
+    sim.diagonals = sim.pipeline = true; // Every kernel, the diagonal planner and speculation included
+    MouseIO io = sim_io(&sim);
+    Solver *s = malloc(sizeof(Solver));
+    if (!solver_init(s, &io)) {
+        free(s);
+        return 0;
+    }
+
+    int taken = 0, search_steps = 0;
+    RunMode mode = s->mouse.mode;
+    while (solver_step(s)) {
+        if (s->mouse.mode == SEARCH_MODE && ++search_steps == SEARCH_SNAPSHOT_STEP) {
+            snapshots[SNAPSHOT_SEARCH] = *s;
+            taken |= 1 << SNAPSHOT_SEARCH;
+        }
+        if (s->mouse.mode != mode) {
+            SnapshotKind kind = s->mouse.mode == SPEED_MODE ? SNAPSHOT_SPEED : SNAPSHOT_GOAL;
+            if (!(taken & (1 << kind))) {
+                snapshots[kind] = *s;
+                taken |= 1 << kind;
+            }
+            mode = s->mouse.mode;
+        }
+    }
+    free(s);
+    return taken;
+}
+
+// --- Timing ---
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Doubles the batch until it runs for min_ns, like Google Benchmark's iteration count
+static void time_kernel(Workspace *w, const Kernel *k, double min_ns, Result *r) {
+    if (k->prepare) k->prepare(w);
+    long iterations = 1;
+    for (;;) {
+        long cells = 0;
+        double start = now_ns();
+        for (long i = 0; i < iterations; i++) cells += k->run(w);
+        double elapsed = now_ns() - start;
+        if (elapsed >= min_ns || iterations >= (1L << 30)) {
+            r->iterations = iterations;
+            r->ns_per_op = elapsed / iterations;
+            r->cells_per_sec = elapsed > 0 ? cells * 1e9 / elapsed : 0;
+            return;
+        }
+        iterations *= 2;
+    }
+}
+
+static Result *add_result(ResultList *list) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? 2 * list->capacity : 256;
+        list->items = realloc(list->items, list->capacity * sizeof(Result));
+    }
+    Result *r = &list->items[list->count++];
+    memset(r, 0, sizeof(*r));
+    return r;
+}
+
+static void bench_maze(const char *path, double min_ns, Solver *snapshots, Workspace *w, ResultList *results) {
+    int taken = take_snapshots(path, snapshots);
+    if (!taken) {
+        fprintf(stderr, "solverbench: cannot solve %s, skipped\n", path);
+        return;
+    }
+    for (int snap = 0; snap < SNAPSHOT_COUNT; snap++) {
+        if (!(taken & (1 << snap))) continue;
+        for (int k = 0; k < KERNEL_COUNT; k++) {
+            w->solver = snapshots[snap]; // Every kernel starts from the same state
+            bind_display(w);
+            Result *r = add_result(results);
+            snprintf(r->maze, sizeof(r->maze), "%s", path);
+            r->snapshot = snapshot_names[snap];
+            r->kernel = kernels[k].name;
+            time_kernel(w, &kernels[k], min_ns, r);
+        }
+    }
+}
+
+// --- Maze Discovery ---
+
+static bool is_maze_file(const char *name) {
+    const char *ext = strrchr(name, '.');
+    return ext && (strcmp(ext, ".num") == 0 || strcmp(ext, ".map") == 0);
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Returns the sorted maze paths in dir, NULL on error
+static char **list_mazes(const char *dir, int *count) {
+    DIR *d = opendir(dir);
+    if (!d) {
+        perror(dir);
+        return NULL;
+    }
+
+    int capacity = 64;
+    char **paths = malloc(capacity * sizeof(char *));
+    *count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (!is_maze_file(entry->d_name)) continue;
+        if (*count == capacity) {
+            capacity *= 2;
+            paths = realloc(paths, capacity * sizeof(char *));
+        }
+        paths[*count] = malloc(MAX_PATH_LENGTH);
+        snprintf(paths[(*count)++], MAX_PATH_LENGTH, "%s/%s", dir, entry->d_name);
+    }
+    closedir(d);
+    qsort(paths, *count, sizeof(char *), compare_names);
+    return paths;
+}
+
+// --- Baseline ---
+
+static const char *base_name(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+// Reads the ns/op of every record of an earlier json output into the matching results
+static bool load_baseline(const char *path, ResultList *results) {
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return false;
+    }
+    char line[MAX_LINE];
+    while (fgets(line, sizeof(line), in)) {
+        char maze[MAX_PATH_LENGTH], snapshot[32], kernel[64];
+        long iterations;
+        double ns_per_op;
+        if (sscanf(line, " {\"maze\": \"%1023[^\"]\", \"snapshot\": \"%31[^\"]\", \"kernel\": \"%63[^\"]\", "
+                         "\"iterations\": %ld, \"ns_per_op\": %lf",
+                   maze, snapshot, kernel, &iterations, &ns_per_op) != 5) {
+            continue;
+        }
+        for (int i = 0; i < results->count; i++) {
+            Result *r = &results->items[i];
+            if (strcmp(base_name(r->maze), base_name(maze)) == 0 && strcmp(r->snapshot, snapshot) == 0 &&
+                strcmp(r->kernel, kernel) == 0) {
+                r->baseline_ns = ns_per_op;
+            }
+        }
+    }
+    fclose(in);
+    return true;
+}
+
+// --- Output ---
+
+static void json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+static void write_results(FILE *out, OutputFormat format, const ResultList *results) {
+    if (format == FORMAT_CSV) {
+        fprintf(out, "maze,snapshot,kernel,iterations,ns_per_op,cells_per_sec,baseline_ns_per_op\n");
+        for (int i = 0; i < results->count; i++) {
+            const Result *r = &results->items[i];
+            fprintf(out, "%s,%s,%s,%ld,%.1f,%.0f,%.1f\n", r->maze, r->snapshot, r->kernel, r->iterations,
+                    r->ns_per_op, r->cells_per_sec, r->baseline_ns);
+        }
+        return;
+    }
+
+    // One record per line, which is what load_baseline reads back
+    fprintf(out, "[\n");
+    for (int i = 0; i < results->count; i++) {
+        const Result *r = &results->items[i];
+        fprintf(out, "  {\"maze\": ");
+        json_string(out, r->maze);
+        fprintf(out, ", \"snapshot\": \"%s\", \"kernel\": \"%s\", \"iterations\": %ld, \"ns_per_op\": %.1f, "
+                     "\"cells_per_sec\": %.0f",
+                r->snapshot, r->kernel, r->iterations, r->ns_per_op, r->cells_per_sec);
+        if (r->baseline_ns > 0) fprintf(out, ", \"baseline_ns_per_op\": %.1f", r->baseline_ns);
+        fprintf(out, "}%s\n", i + 1 < results->count ? "," : "");
+    }
+    fprintf(out, "]\n");
+}
+
+// Mean ns/op per kernel on stderr, with the change against the baseline.
+// Returns the number of kernels slower than the baseline by more than tolerance percent
+static int print_summary(const ResultList *results, bool has_baseline, double tolerance) {
+    int regressions = 0;
+    for (int k = 0; k < KERNEL_COUNT; k++) {
+        double ns = 0, cells = 0, now_sum = 0, base_sum = 0;
+        int count = 0;
+        for (int i = 0; i < results->count; i++) {
+            const Result *r = &results->items[i];
+            if (strcmp(r->kernel, kernels[k].name) != 0) continue;
+            ns += r->ns_per_op;
+            cells += r->cells_per_sec;
+            count++;
+            if (r->baseline_ns > 0) {
+                now_sum += r->ns_per_op;
+                base_sum += r->baseline_ns;
+            }
+        }
+        if (count == 0) continue;
+        fprintf(stderr, "solverbench: %-24s %10.1f ns/op %14.0f cells/sec", kernels[k].name, ns / count,
+                cells / count);
+        if (has_baseline && base_sum > 0) {
+            double change = 100.0 * (now_sum - base_sum) / base_sum;
+            bool regressed = change > tolerance;
+            fprintf(stderr, "  %+6.1f%% vs baseline%s", change, regressed ? "  REGRESSION" : "");
+            if (regressed) regressions++;
+        }
+        fputc('\n', stderr);
+    }
+    return regressions;
+}
+
+// --- Main ---
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-t min_ms] [-f csv|json] [-o output] [-b baseline.json] [-r percent] maze_dir\n"
+            "  -t  minimum time per timed batch in ms (default: 20)\n"
+            "  -f  output format (default: json)\n"
+            "  -o  output file (default: stdout)\n"
+            "  -b  earlier json output to compare against\n"
+            "  -r  slowdown in percent that counts as a regression (default: 10)\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    double min_ms = 20;
+    OutputFormat format = FORMAT_JSON;
+    const char *output = NULL;
+    const char *baseline = NULL;
+    double tolerance = 10;
+
+    int c;
+    while ((c = getopt(argc, argv, "t:f:o:b:r:h")) != -1) {
+        switch (c) {
+            case 't': min_ms = atof(optarg); break;
+            case 'f':
+                if (strcmp(optarg, "csv") == 0) {
+                    format = FORMAT_CSV;
+                } else if (strcmp(optarg, "json") != 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'o': output = optarg; break;
+            case 'b': baseline = optarg; break;
+            case 'r': tolerance = atof(optarg); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (argc - optind != 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int count;
+    char **mazes = list_mazes(argv[optind], &count);
+    if (!mazes) return 1;
+
+    Solver *snapshots = malloc(SNAPSHOT_COUNT * sizeof(Solver));
+    Workspace *workspace = malloc(sizeof(Workspace));
+    ResultList results = {0};
+    for (int i = 0; i < count; i++) {
+        bench_maze(mazes[i], min_ms * 1e6, snapshots, workspace, &results);
+        free(mazes[i]);
+    }
+    free(mazes);
+    free(workspace);
+    free(snapshots);
+
+    if (baseline && !load_baseline(baseline, &results)) return 1;
+
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        perror(output);
+        return 1;
+    }
+    write_results(out, format, &results);
+    if (out != stdout) fclose(out);
+
+    int regressions = print_summary(&results, baseline != NULL, tolerance);
+    free(results.items);
+    return regressions ? 3 : 0;
+}
@@ -0,0 +1,209 @@
+/// tracedump.c
+/// decodes a binary solver trace (SOLVER_TRACE_FILE, see algo/ff/trace.h)
+/// into one text or JSON line per event, and replays the events to rebuild
+/// the mouse's pose and wall map as the run went.
+///
+///   gcc -O2 tracedump.c -o tracedump
+///   SOLVER_TRACE_FILE=run.trace ../algo/ff/ff_headless.out
+///   ./tracedump -f json run.trace
+///   ./tracedump -m known.map run.trace   # walls the mouse found, as an mms .map
+///
+/// the .map written by -m loads back into the headless simulator, so a run
+/// can be replayed offline against exactly what the mouse had sensed.
+
+#include "../algo/ff/trace.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_SIZE 255 // x and y are one byte in a record
+
+typedef enum { FORMAT_TEXT, FORMAT_JSON } OutputFormat;
+
+// replayed run state
+typedef struct {
+    int width, height;
+    int x, y, heading, mode;
+    unsigned long steps, moves, turns, crashes, walls, cells_touched;
+    unsigned char *known; // wall bits per cell, [y * MAX_SIZE + x], bit = heading
+} Replay;
+
+static const char *const kind_names[TRACE_KIND_COUNT] = {
+    "?", "init", "step", "mode", "wall", "move", "turn", "crash", "flood", "plan"};
+static const char *const mode_names[] = {"search", "return", "speed"};
+static const char *const field_names[] = {"goal", "start", "target"};
+static const char heading_names[] = "NESW";
+static const int dx[4] = {0, 1, 0, -1};
+static const int dy[4] = {1, 0, -1, 0};
+
+// --- Replay ---
+
+static void set_known_wall(Replay *r, int x, int y, int heading) {
+    if (x < 0 || x >= r->width || y < 0 || y >= r->height) return;
+    r->known[y * MAX_SIZE + x] |= (unsigned char)(1 << heading);
+    int nx = x + dx[heading], ny = y + dy[heading];
+    if (nx >= 0 && nx < r->width && ny >= 0 && ny < r->height) {
+        r->known[ny * MAX_SIZE + nx] |= (unsigned char)(1 << ((heading + 2) % 4));
+    }
+}
+
+static void replay(Replay *r, const TraceEvent *e) {
+    switch (e->kind) {
+        case TRACE_INIT:
+            // A reset starts over with a fresh map
+            r->width = e->x;
+            r->height = e->y;
+            r->x = r->y = r->heading = r->mode = 0;
+            memset(r->known, 0, MAX_SIZE * MAX_SIZE);
+            break;
+        case TRACE_STEP: r->steps++; r->cells_touched += e->value; break;
+        case TRACE_MODE: r->mode = e->arg; break;
+        case TRACE_WALL: r->walls++; set_known_wall(r, e->x, e->y, e->arg & 3); break;
+        case TRACE_MOVE: r->moves += e->value; break;
+        case TRACE_TURN: r->turns += e->value == 2 ? 2 : 1; break;
+        case TRACE_CRASH: r->crashes++; break;
+        default: break;
+    }
+    if (e->kind == TRACE_MOVE || e->kind == TRACE_TURN) {
+        r->x = e->x;
+        r->y = e->y;
+        r->heading = e->arg & 3;
+    }
+}
+
+// mms ascii map, top row first, 4 characters per cell (loaded by sim.c).
+// The outer walls are never sensed as events, they are always drawn.
+static bool write_map(const Replay *r, const char *path) {
+    FILE *out = fopen(path, "w");
+    if (!out) return false;
+    for (int y = r->height - 1; y >= 0; y--) {
+        for (int x = 0; x < r->width; x++) {
+            fputs((y == r->height - 1 || (r->known[y * MAX_SIZE + x] & 1)) ? "o---" : "o   ", out);
+        }
+        fputs("o\n", out);
+        for (int x = 0; x < r->width; x++) {
+            fputs((x == 0 || (r->known[y * MAX_SIZE + x] & 8)) ? "|   " : "    ", out);
+        }
+        fputs("|\n", out);
+    }
+    for (int x = 0; x < r->width; x++) {
+        fputs("o---", out);
+    }
+    fputs("o\n", out);
+    fclose(out);
+    return true;
+}
+
+// --- Output ---
+
+static void print_text(FILE *out, unsigned long seq, const TraceEvent *e) {
+    const char *mode = e->arg < 3 ? mode_names[e->arg] : "?";
+    char heading = heading_names[e->arg & 3];
+    fprintf(out, "%6lu %-5s (%d,%d) ", seq, kind_names[e->kind], e->x, e->y);
+    switch (e->kind) {
+        case TRACE_INIT: fprintf(out, "maze %dx%d", e->x, e->y); break;
+        case TRACE_STEP: fprintf(out, "heading %c touched %lu", heading, (unsigned long)e->value); break;
+        case TRACE_MODE: fprintf(out, "-> %s", mode); break;
+        case TRACE_WALL: fprintf(out, "side %c", heading); break;
+        case TRACE_MOVE: fprintf(out, "heading %c after %lu cells", heading, (unsigned long)e->value); break;
+        case TRACE_TURN: fprintf(out, "heading %c after %lu quarter turns", heading, (unsigned long)e->value); break;
+        case TRACE_CRASH: fprintf(out, "heading %c", heading); break;
+        case TRACE_FLOOD:
+            fprintf(out, "%s touched %lu", e->arg < 3 ? field_names[e->arg] : "?", (unsigned long)e->value);
+            break;
+        case TRACE_PLAN: fprintf(out, "%d moves est. %lu ms", e->arg, (unsigned long)e->value); break;
+        default: break;
+    }
+    fputc('\n', out);
+}
+
+static void print_json(FILE *out, unsigned long seq, const TraceEvent *e) {
+    fprintf(out, "{\"seq\": %lu, \"event\": \"%s\", \"x\": %d, \"y\": %d, \"arg\": %d, \"value\": %lu}\n", seq,
+            kind_names[e->kind], e->x, e->y, e->arg, (unsigned long)e->value);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-f text|json] [-s] [-m map_out] trace_file\n"
+            "  -f  event output format (default text)\n"
+            "  -s  summary only, no per-event lines\n"
+            "  -m  write the walls the mouse found as an mms .map file\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    OutputFormat format = FORMAT_TEXT;
+    bool summary_only = false;
+    const char *map_path = NULL;
+
+    int c;
+    while ((c = getopt(argc, argv, "f:sm:h")) != -1) {
+        switch (c) {
+            case 'f':
+                if (strcmp(optarg, "json") == 0) {
+                    format = FORMAT_JSON;
+                } else if (strcmp(optarg, "text") != 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 's': summary_only = true; break;
+            case 'm': map_path = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (argc - optind != 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE *in = fopen(argv[optind], "rb");
+    if (!in) {
+        perror(argv[optind]);
+        return 1;
+    }
+    TraceFileHeader header;
+    if (fread(&header, sizeof(header), 1, in) != 1 || memcmp(header.magic, TRACE_FILE_MAGIC, 4) != 0 ||
+        header.version != TRACE_FILE_VERSION || header.record_size != sizeof(TraceEvent)) {
+        fprintf(stderr, "tracedump: %s is not a version %d trace\n", argv[optind], TRACE_FILE_VERSION);
+        fclose(in);
+        return 1;
+    }
+
+    Replay r = {0};
+    r.known = calloc(MAX_SIZE * MAX_SIZE, 1);
+    unsigned long seq = 0;
+    TraceEvent e;
+    while (fread(&e, sizeof(e), 1, in) == 1) {
+        if (e.kind == 0 || e.kind >= TRACE_KIND_COUNT) {
+            fprintf(stderr, "tracedump: unknown event kind %d at record %lu\n", e.kind, seq);
+            break;
+        }
+        replay(&r, &e);
+        if (!summary_only) {
+            if (format == FORMAT_JSON) {
+                print_json(stdout, seq, &e);
+            } else {
+                print_text(stdout, seq, &e);
+            }
+        }
+        seq++;
+    }
+    fclose(in);
+
+    fprintf(stderr,
+            "tracedump: %lu events, maze %dx%d, %lu steps, %lu cells moved, %lu turns, %lu crashes, "
+            "%lu walls, %lu cells touched, final (%d,%d) %c %s\n",
+            seq, r.width, r.height, r.steps, r.moves, r.turns, r.crashes, r.walls, r.cells_touched, r.x, r.y,
+            heading_names[r.heading], r.mode < 3 ? mode_names[r.mode] : "?");
+
+    if (map_path && !write_map(&r, map_path)) {
+        perror(map_path);
+        free(r.known);
+        return 1;
+    }
+    free(r.known);
+    return 0;
+}